@@ -6,6 +6,7 @@
 
 #include <Castro.H>
 #include <Castro_F.H>
+#include <Castro_sums.H>
 #include <AMReX_Geometry.H>
 #include <AMReX_ParallelDescriptor.H>
 
@@ -155,53 +156,68 @@ Castro::sum_integrated_quantities ()
       species_mass[i]  = 0.0;
     }
 
-    for (int lev = 0; lev <= finest_level; lev++)
-    {
-
-      // Update the local level we're on.
-
-      ca_set_amr_info(lev, -1, -1, -1.0, -1.0);
+    // The volume integrals, all computed in one sweep over each level.
 
-      // Get the current level from Castro
+    IntegralSums isum;
 
-      Castro& ca_lev = getLevel(lev);
-
-      for ( int i = 0; i < 3; i++ ) {
-        com[i] += ca_lev.locWgtSum("density", time, i, local_flag);
-      }
+    const int icom = isum.addLocation("density", 0);
+    isum.addLocation("density", 1);
+    isum.addLocation("density", 2);
 
-      // Calculate total mass, momentum, angular momentum, and energy of system.
+    const int imass = isum.addVolume("density");
 
-      mass += ca_lev.volWgtSum("density", time, local_flag);
+    const int imomentum = isum.addVolume("inertial_momentum_x");
+    isum.addVolume("inertial_momentum_y");
+    isum.addVolume("inertial_momentum_z");
 
-      momentum[0] += ca_lev.volWgtSum("inertial_momentum_x", time, local_flag);
-      momentum[1] += ca_lev.volWgtSum("inertial_momentum_y", time, local_flag);
-      momentum[2] += ca_lev.volWgtSum("inertial_momentum_z", time, local_flag);
-
-      angular_momentum[0] += ca_lev.volWgtSum("inertial_angular_momentum_x", time, local_flag);
-      angular_momentum[1] += ca_lev.volWgtSum("inertial_angular_momentum_y", time, local_flag);
-      angular_momentum[2] += ca_lev.volWgtSum("inertial_angular_momentum_z", time, local_flag);
+    const int iangular_momentum = isum.addVolume("inertial_angular_momentum_x");
+    isum.addVolume("inertial_angular_momentum_y");
+    isum.addVolume("inertial_angular_momentum_z");
 
 #ifdef HYBRID_MOMENTUM
-      hybrid_momentum[0] += ca_lev.volWgtSum("rmom", time, local_flag);
-      hybrid_momentum[1] += ca_lev.volWgtSum("lmom", time, local_flag);
-      hybrid_momentum[2] += ca_lev.volWgtSum("pmom", time, local_flag);
+    const int ihybrid_momentum = isum.addVolume("rmom");
+    isum.addVolume("lmom");
+    isum.addVolume("pmom");
 #endif
 
-      rho_E += ca_lev.volWgtSum("rho_E", time, local_flag);
-      rho_K += ca_lev.volWgtSum("kineng",time, local_flag);
-      rho_e += ca_lev.volWgtSum("rho_e", time, local_flag);
+    const int irho_E = isum.addVolume("rho_E");
+    const int irho_K = isum.addVolume("kineng");
+    const int irho_e = isum.addVolume("rho_e");
 
+    int irho_phi = -1;
 #ifdef GRAVITY
-      if (do_grav)
-        rho_phi += ca_lev.volProductSum("density", "phiGrav", time, local_flag);
+    if (do_grav)
+      irho_phi = isum.addProduct("density", "phiGrav");
 #endif
 
+    int irho_phirot = -1;
 #ifdef ROTATION
-      if (do_rotation)
-	rho_phirot += ca_lev.volProductSum("density", "phiRot", time, local_flag);
+    if (do_rotation)
+      irho_phirot = isum.addProduct("density", "phiRot");
 #endif
 
+    const int ispecies = isum.size();
+    for (int i = 0; i < NumSpec; i++)
+      isum.addVolume("rho_" + species_names[i]);
+
+    Real strt_time = amrex::ParallelDescriptor::second();
+
+    for (int lev = 0; lev <= finest_level; lev++)
+    {
+
+      // Update the local level we're on.
+
+      ca_set_amr_info(lev, -1, -1, -1.0, -1.0);
+
+      // Get the current level from Castro
+
+      Castro& ca_lev = getLevel(lev);
+
+      // Calculate total mass, momentum, angular momentum, and energy of system,
+      // the center of mass, and the integrated mass of all species on the domain.
+
+      ca_lev.integrate(isum, time);
+
 #ifdef GRAVITY
 #if (BL_SPACEDIM > 1)
       // Gravitational wave signal. This is designed to add to these quantities so we can send them directly.
@@ -209,12 +225,38 @@ Castro::sum_integrated_quantities ()
 #endif
 #endif
 
-      // Integrated mass of all species on the domain.
-      for (int i = 0; i < NumSpec; i++)
-	species_mass[i] += ca_lev.volWgtSum("rho_" + species_names[i], time, local_flag) / M_solar;
+    }
+
+    if (verbose > 1) {
+      Real run_time = amrex::ParallelDescriptor::second() - strt_time;
+      amrex::ParallelDescriptor::ReduceRealMax(run_time, amrex::ParallelDescriptor::IOProcessorNumber());
+      amrex::Print() << "Castro::sum_integrated_quantities() integrals computed in " << run_time << " seconds" << std::endl;
+    }
+
+    mass = isum[imass];
 
+    for (int i = 0; i < 3; i++) {
+      com[i]              = isum[icom + i];
+      momentum[i]         = isum[imomentum + i];
+      angular_momentum[i] = isum[iangular_momentum + i];
+#ifdef HYBRID_MOMENTUM
+      hybrid_momentum[i]  = isum[ihybrid_momentum + i];
+#endif
     }
 
+    rho_E = isum[irho_E];
+    rho_K = isum[irho_K];
+    rho_e = isum[irho_e];
+
+    if (irho_phi >= 0)
+      rho_phi = isum[irho_phi];
+
+    if (irho_phirot >= 0)
+      rho_phirot = isum[irho_phirot];
+
+    for (int i = 0; i < NumSpec; i++)
+      species_mass[i] = isum[ispecies + i] / M_solar;
+
     // Return to the original level.
 
     ca_set_amr_info(level, -1, -1, -1.0, -1.0);
@@ -0,0 +1,28 @@
+#include <new>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+
+#include <AMReX_REAL.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_ParallelDescriptor.H>
+
+extern "C"
+{
+   void do_eos();
+}
+
+int
+main (int   argc,
+      char* argv[])
+{
+
+    amrex::Initialize(argc,argv);
+
+    do_eos();
+
+    amrex::Finalize();
+
+    return 0;
+}
@@ -0,0 +1,154 @@
+! Compare the throughput of the zone-by-zone eos() interface against
+! the batched eos_vec interface used by the hydro kernels, for both
+! (rho, T) and (rho, e) inputs, and check that they agree.
+
+subroutine do_eos() bind(C)
+
+  use network
+  use eos_type_module, only : eos_t, eos_input_rt, eos_input_re, eos_vec_len
+  use eos_module
+  use actual_eos_module, only : eos_name
+  use amrex_constants_module, only : ZERO, ONE
+  use extern_probin_module, only: npts, nreps, dens_min, dens_max, temp_min, temp_max
+
+  use amrex_fort_module, only : rt => amrex_real
+  implicit none
+
+  real(rt)        , allocatable :: rho(:), T(:), e(:), p(:), xn(:,:), aux(:,:)
+  real(rt)        , allocatable :: gam1(:), cs(:), dpdr_e(:), dpde(:)
+  real(rt)        , allocatable :: T_ref(:), e_ref(:), p_ref(:)
+
+  real(rt)         :: dlogrho, dlogT
+  real(rt)         :: start, finish
+  real(rt)         :: t_scalar_rt, t_vec_rt, t_scalar_re, t_vec_re
+  real(rt)         :: err_rt, err_re
+
+  integer :: i, i0, i1, n, r
+
+  type (eos_t) :: eos_state
+
+  character (len=32) :: probin_file
+  integer :: probin_pass(32)
+
+  probin_file = "probin"
+  do n = 1, len(trim(probin_file))
+     probin_pass(n) = ichar(probin_file(n:n))
+  enddo
+
+  call runtime_init(probin_pass(1:len(trim(probin_file))), len(trim(probin_file)))
+
+  call network_init()
+  call eos_init()
+
+  allocate(rho(npts), T(npts), e(npts), p(npts))
+  allocate(xn(npts,nspec), aux(npts,naux))
+  allocate(gam1(npts), cs(npts), dpdr_e(npts), dpde(npts))
+  allocate(T_ref(npts), e_ref(npts), p_ref(npts))
+
+  ! Sweep through log rho and log T so that the inputs aren't uniform.
+
+  dlogrho = (log10(dens_max) - log10(dens_min)) / npts
+  dlogT   = (log10(temp_max) - log10(temp_min)) / npts
+
+  xn(:,:) = ONE / nspec
+  aux(:,:) = ZERO
+
+  ! (rho, T) -> e, p: zone by zone
+
+  call cpu_time(start)
+
+  do r = 1, nreps
+     do i = 1, npts
+        eos_state % rho = 10.0e0_rt**(log10(dens_min) + dble(i)*dlogrho)
+        eos_state % T   = 10.0e0_rt**(log10(temp_max) - dble(i)*dlogT)
+        eos_state % xn  = xn(i,:)
+        eos_state % aux = aux(i,:)
+
+        call eos(eos_input_rt, eos_state)
+
+        e_ref(i) = eos_state % e
+        p_ref(i) = eos_state % p
+     enddo
+  enddo
+
+  call cpu_time(finish)
+  t_scalar_rt = finish - start
+
+  ! (rho, T) -> e, p: batched
+
+  call cpu_time(start)
+
+  do r = 1, nreps
+     do i = 1, npts
+        rho(i) = 10.0e0_rt**(log10(dens_min) + dble(i)*dlogrho)
+        T(i)   = 10.0e0_rt**(log10(temp_max) - dble(i)*dlogT)
+     enddo
+
+     do i0 = 1, npts, eos_vec_len
+        i1 = min(i0 + eos_vec_len - 1, npts)
+        call eos_vec(eos_input_rt, i1-i0+1, rho(i0:i1), T(i0:i1), e(i0:i1), p(i0:i1), &
+                     xn(i0:i1,:), aux(i0:i1,:), gam1(i0:i1), cs(i0:i1), &
+                     dpdr_e(i0:i1), dpde(i0:i1))
+     enddo
+  enddo
+
+  call cpu_time(finish)
+  t_vec_rt = finish - start
+
+  err_rt = max(maxval(abs(e - e_ref) / abs(e_ref)), maxval(abs(p - p_ref) / abs(p_ref)))
+
+  ! (rho, e) -> T, p: zone by zone, starting from the e we just found
+
+  call cpu_time(start)
+
+  do r = 1, nreps
+     do i = 1, npts
+        eos_state % rho = rho(i)
+        eos_state % e   = e_ref(i)
+        eos_state % T   = temp_min
+        eos_state % xn  = xn(i,:)
+        eos_state % aux = aux(i,:)
+
+        call eos(eos_input_re, eos_state)
+
+        T_ref(i) = eos_state % T
+        p_ref(i) = eos_state % p
+     enddo
+  enddo
+
+  call cpu_time(finish)
+  t_scalar_re = finish - start
+
+  ! (rho, e) -> T, p: batched
+
+  call cpu_time(start)
+
+  do r = 1, nreps
+     e(:) = e_ref(:)
+     T(:) = temp_min
+
+     do i0 = 1, npts, eos_vec_len
+        i1 = min(i0 + eos_vec_len - 1, npts)
+        call eos_vec(eos_input_re, i1-i0+1, rho(i0:i1), T(i0:i1), e(i0:i1), p(i0:i1), &
+                     xn(i0:i1,:), aux(i0:i1,:), gam1(i0:i1), cs(i0:i1), &
+                     dpdr_e(i0:i1), dpde(i0:i1))
+     enddo
+  enddo
+
+  call cpu_time(finish)
+  t_vec_re = finish - start
+
+  err_re = max(maxval(abs(T - T_ref) / abs(T_ref)), maxval(abs(p - p_ref) / abs(p_ref)))
+
+  print *, 'EOS: ', trim(eos_name), ', batch length = ', eos_vec_len
+  print *, 'zones per call sweep = ', npts, ', repetitions = ', nreps
+  print *, ' '
+  print *, 'eos_input_rt: zones/s (scalar) = ', dble(npts) * nreps / t_scalar_rt
+  print *, 'eos_input_rt: zones/s (vector) = ', dble(npts) * nreps / t_vec_rt
+  print *, 'eos_input_rt: max rel. difference = ', err_rt
+  print *, ' '
+  print *, 'eos_input_re: zones/s (scalar) = ', dble(npts) * nreps / t_scalar_re
+  print *, 'eos_input_re: zones/s (vector) = ', dble(npts) * nreps / t_vec_re
+  print *, 'eos_input_re: max rel. difference = ', err_re
+
+end subroutine do_eos
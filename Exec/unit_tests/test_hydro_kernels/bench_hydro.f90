@@ -0,0 +1,88 @@
+! Helpers for the hydro kernel benchmark: a smooth synthetic state, and a
+! way to switch the hydro method and Riemann solver between runs without
+! going back through ca_set_castro_method_params.
+
+subroutine init_bench_state(lo, hi, state, s_lo, s_hi, dx) bind(C, name="init_bench_state")
+
+  use network, only : nspec, naux
+  use eos_type_module, only : eos_t, eos_input_rp
+  use eos_module
+  use amrex_constants_module, only : ZERO, HALF, ONE, TWO, M_PI
+  use meth_params_module, only : NVAR, URHO, UMX, UMY, UMZ, UEDEN, UEINT, UTEMP, UFS, UFX
+  use extern_probin_module, only : dens_base, pres_base, pert_amp, vel_amp
+
+  use amrex_fort_module, only : rt => amrex_real
+  implicit none
+
+  integer,  intent(in   ) :: lo(3), hi(3), s_lo(3), s_hi(3)
+  real(rt), intent(inout) :: state(s_lo(1):s_hi(1),s_lo(2):s_hi(2),s_lo(3):s_hi(3),NVAR)
+  real(rt), intent(in   ) :: dx(3)
+
+  integer  :: i, j, k
+  real(rt) :: x, y, z, sx, sy, sz, u, v, w
+
+  type (eos_t) :: eos_state
+
+  ! periodic waves on the unit cube, with a few wavelengths across it
+  ! so every reconstruction and Riemann solver path gets exercised; the
+  ! ghost zones are filled from the same functions.  dx is zero in the
+  ! directions we don't have, where the waves are then constant.
+
+  do k = lo(3), hi(3)
+     z = (dble(k) + HALF) * dx(3)
+     sz = cos(TWO * M_PI * z)
+
+     do j = lo(2), hi(2)
+        y = (dble(j) + HALF) * dx(2)
+        sy = cos(4.0e0_rt * M_PI * y)
+
+        do i = lo(1), hi(1)
+           x = (dble(i) + HALF) * dx(1)
+           sx = sin(6.0e0_rt * M_PI * x)
+
+           eos_state % rho = dens_base * (ONE + pert_amp * sx * sy * sz)
+           eos_state % p   = pres_base * (ONE + pert_amp * cos(TWO * M_PI * (x + y + z)))
+           eos_state % T   = 1.0e4_rt
+           eos_state % xn  = ONE / nspec
+           eos_state % aux = ZERO
+
+           call eos(eos_input_rp, eos_state)
+
+           u = vel_amp * sy
+           v = vel_amp * sz
+           w = vel_amp * sx
+
+           state(i,j,k,:) = ZERO
+           state(i,j,k,URHO) = eos_state % rho
+           state(i,j,k,UMX) = eos_state % rho * u
+           state(i,j,k,UMY) = eos_state % rho * v
+           state(i,j,k,UMZ) = eos_state % rho * w
+           state(i,j,k,UEINT) = eos_state % rho * eos_state % e
+           state(i,j,k,UEDEN) = eos_state % rho * (eos_state % e + HALF * (u**2 + v**2 + w**2))
+           state(i,j,k,UTEMP) = eos_state % T
+           state(i,j,k,UFS:UFS-1+nspec) = eos_state % rho * eos_state % xn
+           if (naux > 0) then
+              state(i,j,k,UFX:UFX-1+naux) = eos_state % rho * eos_state % aux
+           endif
+
+        enddo
+     enddo
+  enddo
+
+end subroutine init_bench_state
+
+
+
+subroutine set_bench_method(do_ctu_in, fourth_order_in, riemann_solver_in) bind(C, name="set_bench_method")
+
+  use meth_params_module, only : do_ctu, fourth_order, riemann_solver
+
+  implicit none
+
+  integer, intent(in), value :: do_ctu_in, fourth_order_in, riemann_solver_in
+
+  do_ctu = do_ctu_in
+  fourth_order = fourth_order_in
+  riemann_solver = riemann_solver_in
+
+end subroutine set_bench_method
@@ -0,0 +1,472 @@
+#include <new>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <limits>
+#include <algorithm>
+
+#include <AMReX_REAL.H>
+#include <AMReX_Vector.H>
+#include <AMReX_Box.H>
+#include <AMReX_BoxArray.H>
+#include <AMReX_FArrayBox.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_BC_TYPES.H>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "Castro_F.H"
+
+using namespace amrex;
+
+extern "C"
+{
+    void init_bench_state(const int* lo, const int* hi,
+                          BL_FORT_FAB_ARG_3D(state),
+                          const Real* dx);
+
+    void set_bench_method(int do_ctu, int fourth_order, int riemann_solver);
+}
+
+namespace {
+
+    int NUM_STATE, NUM_GROW, QVAR, NQ, NQAUX;
+
+    const int dm = BL_SPACEDIM;
+
+    //
+    // The per-run data: the state on the whole domain (with ghost zones)
+    // and the primitive variables made from it, the outputs of the
+    // update, and the geometric factors.
+    //
+    struct BenchData {
+        Box domain;
+        Real dx[3];
+        FArrayBox state, stateout, q, qaux, src_q, srcU, update, update_flux;
+        FArrayBox area[BL_SPACEDIM], volume;
+#if (BL_SPACEDIM < 3)
+        FArrayBox dloga;
+#endif
+    };
+
+    void ctoprim (BenchData& d)
+    {
+        const Box& qbx = d.q.box();
+
+        ca_ctoprim(AMREX_INT_ANYD(qbx.loVect()), AMREX_INT_ANYD(qbx.hiVect()),
+                   BL_TO_FORTRAN_ANYD(d.state),
+                   BL_TO_FORTRAN_ANYD(d.q),
+                   BL_TO_FORTRAN_ANYD(d.qaux));
+    }
+
+    //
+    // One update of the whole domain with the given method, split into
+    // tiles of at most tile_size zones on a side and shared out over the
+    // threads as in the Castro hydro drivers.
+    //
+    void update (BenchData& d, const std::string& method, const BoxArray& tiles, Real dt)
+    {
+        const int* domlo = d.domain.loVect();
+        const int* domhi = d.domain.hiVect();
+
+        const Real time = 0.0;
+        const Real stage_weight = 1.0;
+        const int is_finest_level = 1;
+        const int verbose = 0;
+
+        d.update.setVal(0.0);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            FArrayBox flux[BL_SPACEDIM];
+#if (BL_SPACEDIM < 3)
+            FArrayBox pradial;
+#endif
+
+            Real mass_lost = 0.0, xmom_lost = 0.0, ymom_lost = 0.0, zmom_lost = 0.0;
+            Real eden_lost = 0.0, xang_lost = 0.0, yang_lost = 0.0, zang_lost = 0.0;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+            for (int t = 0; t < tiles.size(); ++t) {
+
+                const Box& bx = tiles[t];
+
+                const int* lo = bx.loVect();
+                const int* hi = bx.hiVect();
+
+                for (int i = 0; i < BL_SPACEDIM; ++i)
+                    flux[i].resize(amrex::surroundingNodes(bx, i), NUM_STATE);
+
+#if (BL_SPACEDIM < 3)
+                pradial.resize(amrex::surroundingNodes(bx, 0), 1);
+#endif
+
+                if (method == "ctu") {
+
+                    ca_ctu_update
+                        (ARLIM_3D(lo), ARLIM_3D(hi), &is_finest_level, &time,
+                         ARLIM_3D(domlo), ARLIM_3D(domhi),
+                         BL_TO_FORTRAN_ANYD(d.state),
+                         BL_TO_FORTRAN_ANYD(d.stateout),
+                         BL_TO_FORTRAN_ANYD(d.q),
+                         BL_TO_FORTRAN_ANYD(d.qaux),
+                         BL_TO_FORTRAN_ANYD(d.src_q),
+                         BL_TO_FORTRAN_ANYD(d.update),
+                         d.dx, &dt,
+                         D_DECL(BL_TO_FORTRAN_ANYD(flux[0]),
+                                BL_TO_FORTRAN_ANYD(flux[1]),
+                                BL_TO_FORTRAN_ANYD(flux[2])),
+#if (BL_SPACEDIM < 3)
+                         BL_TO_FORTRAN_ANYD(pradial),
+#endif
+                         D_DECL(BL_TO_FORTRAN_ANYD(d.area[0]),
+                                BL_TO_FORTRAN_ANYD(d.area[1]),
+                                BL_TO_FORTRAN_ANYD(d.area[2])),
+#if (BL_SPACEDIM < 3)
+                         BL_TO_FORTRAN_ANYD(d.dloga),
+#endif
+                         BL_TO_FORTRAN_ANYD(d.volume),
+                         verbose,
+                         mass_lost, xmom_lost, ymom_lost, zmom_lost,
+                         eden_lost, xang_lost, yang_lost, zang_lost);
+
+                } else if (method == "mol") {
+
+                    ca_mol_single_stage
+                        (ARLIM_3D(lo), ARLIM_3D(hi), &time, ARLIM_3D(domlo), ARLIM_3D(domhi),
+                         &stage_weight,
+                         BL_TO_FORTRAN_ANYD(d.state),
+                         BL_TO_FORTRAN_ANYD(d.stateout),
+                         BL_TO_FORTRAN_ANYD(d.q),
+                         BL_TO_FORTRAN_ANYD(d.qaux),
+                         BL_TO_FORTRAN_ANYD(d.srcU),
+                         BL_TO_FORTRAN_ANYD(d.update),
+                         BL_TO_FORTRAN_ANYD(d.update_flux),
+                         d.dx, &dt,
+                         D_DECL(BL_TO_FORTRAN_ANYD(flux[0]),
+                                BL_TO_FORTRAN_ANYD(flux[1]),
+                                BL_TO_FORTRAN_ANYD(flux[2])),
+#if (BL_SPACEDIM < 3)
+                         BL_TO_FORTRAN_ANYD(pradial),
+#endif
+                         D_DECL(BL_TO_FORTRAN_ANYD(d.area[0]),
+                                BL_TO_FORTRAN_ANYD(d.area[1]),
+                                BL_TO_FORTRAN_ANYD(d.area[2])),
+#if (BL_SPACEDIM < 3)
+                         BL_TO_FORTRAN_ANYD(d.dloga),
+#endif
+                         BL_TO_FORTRAN_ANYD(d.volume),
+                         verbose);
+
+                } else {
+
+                    // The cell-average and cell-center primitive states
+                    // only differ by the Laplacian correction, which
+                    // doesn't change the cost, so we use q for both.
+
+                    ca_fourth_single_stage
+                        (ARLIM_3D(lo), ARLIM_3D(hi), &time, ARLIM_3D(domlo), ARLIM_3D(domhi),
+                         &stage_weight,
+                         BL_TO_FORTRAN_ANYD(d.state),
+                         BL_TO_FORTRAN_ANYD(d.stateout),
+                         BL_TO_FORTRAN_ANYD(d.q),
+                         BL_TO_FORTRAN_ANYD(d.q),
+                         BL_TO_FORTRAN_ANYD(d.qaux),
+                         BL_TO_FORTRAN_ANYD(d.srcU),
+                         BL_TO_FORTRAN_ANYD(d.update),
+                         BL_TO_FORTRAN_ANYD(d.update_flux),
+                         d.dx, &dt,
+                         D_DECL(BL_TO_FORTRAN_ANYD(flux[0]),
+                                BL_TO_FORTRAN_ANYD(flux[1]),
+                                BL_TO_FORTRAN_ANYD(flux[2])),
+#if (BL_SPACEDIM < 3)
+                         BL_TO_FORTRAN_ANYD(pradial),
+#endif
+                         D_DECL(BL_TO_FORTRAN_ANYD(d.area[0]),
+                                BL_TO_FORTRAN_ANYD(d.area[1]),
+                                BL_TO_FORTRAN_ANYD(d.area[2])),
+#if (BL_SPACEDIM < 3)
+                         BL_TO_FORTRAN_ANYD(d.dloga),
+#endif
+                         BL_TO_FORTRAN_ANYD(d.volume),
+                         verbose);
+
+                }
+            }
+        }
+    }
+
+}
+
+int
+main (int   argc,
+      char* argv[])
+{
+
+    amrex::Initialize(argc,argv);
+
+    // the microphysics runtime parameters and the synthetic state come
+    // from the probin
+
+    std::string probin_file = "probin";
+    const int probin_file_length = probin_file.length();
+    Vector<int> probin_file_name(probin_file_length);
+
+    for (int i = 0; i < probin_file_length; i++)
+        probin_file_name[i] = probin_file[i];
+
+    ca_extern_init(probin_file_name.dataPtr(), &probin_file_length);
+
+    ca_network_init();
+
+    // set up the state indices the same way Castro::variableSetUp does
+
+    int NumSpec, NumAux, NumAdv;
+
+    ca_get_num_spec(&NumSpec);
+    ca_get_num_aux(&NumAux);
+    ca_get_num_adv(&NumAdv);
+
+    int Density, Xmom, Ymom, Zmom, Eden, Eint, Temp;
+    int FirstAdv, FirstSpec, FirstAux;
+
+    int QRHO, QU, QV, QW, QGAME, QPRES, QREINT, QTEMP;
+    int QFA, QFS, QFX;
+
+#include "set_conserved.H"
+
+    NUM_STATE = cnt;
+
+#include "set_primitive.H"
+
+    ca_get_method_params(&NUM_GROW);
+
+    // castro.* parameters (ppm_type, small_dens, ...) come from the
+    // inputs file
+
+    ca_set_castro_method_params();
+
+    std::string gravity_type = "none";
+    const int gravity_type_length = gravity_type.length();
+    Vector<int> gravity_type_name(gravity_type_length);
+
+    for (int i = 0; i < gravity_type_length; i++)
+        gravity_type_name[i] = gravity_type[i];
+
+    ca_set_method_params(dm, Density, Xmom, Eden, Eint, Temp,
+                         FirstAdv, FirstSpec, FirstAux,
+                         QRHO, QU, QV, QW,
+                         QGAME, QPRES, QREINT,
+                         QTEMP,
+                         QFA, QFS, QFX,
+                         gravity_type_name.dataPtr(), gravity_type_length);
+
+    ca_get_qvar(&QVAR);
+    ca_get_nq(&NQ);
+    ca_get_nqaux(&NQAUX);
+
+    // a periodic unit cube: all interior boundaries, and the ghost
+    // zones are filled from the same functions as the valid zones
+
+    int physbc[BL_SPACEDIM] = {AMREX_D_DECL(Interior, Interior, Interior)};
+    Real problo[BL_SPACEDIM] = {AMREX_D_DECL(0.0, 0.0, 0.0)};
+    Real probhi[BL_SPACEDIM] = {AMREX_D_DECL(1.0, 1.0, 1.0)};
+    Real center[BL_SPACEDIM] = {AMREX_D_DECL(0.5, 0.5, 0.5)};
+
+    ca_set_problem_params(dm, physbc, physbc,
+                          Interior, Inflow, Outflow, Symmetry, SlipWall, NoSlipWall,
+                          0, problo, probhi, center);
+
+    // what to run
+
+    ParmParse pp("bench");
+
+    Vector<int> n_cell(BL_SPACEDIM, 64);
+    pp.queryarr("n_cell", n_cell, 0, BL_SPACEDIM);
+
+    int nreps = 5;
+    pp.query("nreps", nreps);
+
+    Real cfl = 0.5;
+    pp.query("cfl", cfl);
+
+    Vector<std::string> methods = {"ctu", "mol", "fourth"};
+    if (pp.contains("methods"))
+        pp.getarr("methods", methods);
+
+    Vector<int> riemann_solvers = {0, 1, 2};
+    if (pp.contains("riemann_solvers"))
+        pp.getarr("riemann_solvers", riemann_solvers);
+
+    // tiles are tile_size zones on a side; 0 means one tile for the
+    // whole domain
+
+    Vector<int> tile_sizes = {16, 32, 0};
+    if (pp.contains("tile_sizes"))
+        pp.getarr("tile_sizes", tile_sizes);
+
+#ifdef _OPENMP
+    Vector<int> nthreads = {omp_get_max_threads()};
+#else
+    Vector<int> nthreads = {1};
+#endif
+    if (pp.contains("nthreads"))
+        pp.getarr("nthreads", nthreads);
+
+    // the synthetic state
+
+    BenchData d;
+
+    d.domain = Box(IntVect::TheZeroVector(), IntVect(n_cell.dataPtr()) - IntVect::TheUnitVector());
+
+    for (int i = 0; i < 3; ++i)
+        d.dx[i] = (i < BL_SPACEDIM) ? 1.0 / n_cell[i] : 0.0;
+
+    const Box gbx = amrex::grow(d.domain, NUM_GROW);
+
+    d.state.resize(gbx, NUM_STATE);
+    d.stateout.resize(d.domain, NUM_STATE);
+    d.q.resize(gbx, NQ);
+    d.qaux.resize(gbx, NQAUX);
+    d.src_q.resize(gbx, QVAR);
+    d.srcU.resize(gbx, NUM_STATE);
+    d.update.resize(d.domain, NUM_STATE);
+    d.update_flux.resize(d.domain, NUM_STATE);
+
+    d.src_q.setVal(0.0);
+    d.srcU.setVal(0.0);
+
+    init_bench_state(ARLIM_3D(gbx.loVect()), ARLIM_3D(gbx.hiVect()),
+                     BL_TO_FORTRAN_3D(d.state), d.dx);
+
+    d.stateout.copy(d.state, d.domain);
+
+    // Cartesian geometry
+
+    Real vol = 1.0;
+    for (int i = 0; i < BL_SPACEDIM; ++i)
+        vol *= d.dx[i];
+
+    for (int i = 0; i < BL_SPACEDIM; ++i) {
+        d.area[i].resize(amrex::surroundingNodes(gbx, i), 1);
+        d.area[i].setVal(vol / d.dx[i]);
+    }
+
+    d.volume.resize(gbx, 1);
+    d.volume.setVal(vol);
+
+#if (BL_SPACEDIM < 3)
+    d.dloga.resize(gbx, 1);
+    d.dloga.setVal(0.0);
+#endif
+
+    // the timestep from the CFL condition on the initial state
+
+    ctoprim(d);
+
+    Real courno = -std::numeric_limits<Real>::max();
+    const Real dt_unit = 1.0;
+
+    ca_compute_cfl(BL_TO_FORTRAN_BOX(d.domain),
+                   BL_TO_FORTRAN_ANYD(d.q),
+                   BL_TO_FORTRAN_ANYD(d.qaux),
+                   dt_unit, d.dx, &courno, 0);
+
+    const Real dt = cfl / courno;
+
+    const Real zones = d.domain.numPts();
+
+    amrex::Print() << "domain = " << d.domain << ", NUM_GROW = " << NUM_GROW
+                   << ", repetitions = " << nreps << ", dt = " << dt << "\n\n";
+
+    amrex::Print() << std::setw(8) << "method" << std::setw(9) << "riemann"
+                   << std::setw(6) << "tile" << std::setw(9) << "threads"
+                   << std::setw(14) << "ctoprim z/s" << std::setw(14) << "update z/s"
+                   << std::setw(9) << "speedup" << std::setw(24) << "checksum" << "\n";
+
+    for (const auto& method : methods) {
+
+        if (method != "ctu" && method != "mol" && method != "fourth")
+            amrex::Abort("bench.methods must be ctu, mol or fourth");
+
+        for (int riemann_solver : riemann_solvers) {
+
+#if (BL_SPACEDIM == 1)
+            if (riemann_solver == 2) continue;  // no HLLC in 1-d
+#endif
+
+            set_bench_method(method == "ctu", method == "fourth", riemann_solver);
+
+            for (int tile_size : tile_sizes) {
+
+                // the fourth order update can't be tiled, because of
+                // the Laplacian corrections
+
+                if (method == "fourth" && tile_size != 0) continue;
+
+                BoxArray tiles(d.domain);
+                if (tile_size > 0)
+                    tiles.maxSize(tile_size);
+
+                Real first_rate = 0.0;
+
+                for (int nt : nthreads) {
+
+#ifdef _OPENMP
+                    omp_set_num_threads(nt);
+#endif
+
+                    // The best of nreps, each from the same starting
+                    // primitive state.
+
+                    Real t_ctoprim = std::numeric_limits<Real>::max();
+                    Real t_update  = std::numeric_limits<Real>::max();
+
+                    for (int r = 0; r < nreps; ++r) {
+
+                        Real strt = ParallelDescriptor::second();
+                        ctoprim(d);
+                        t_ctoprim = std::min(t_ctoprim, ParallelDescriptor::second() - strt);
+
+                        strt = ParallelDescriptor::second();
+                        update(d, method, tiles, dt);
+                        t_update = std::min(t_update, ParallelDescriptor::second() - strt);
+
+                    }
+
+                    const Real rate = zones / t_update;
+
+                    if (first_rate == 0.0) first_rate = rate;
+
+                    // The L1 norm of the update, to check that different
+                    // tilings and thread counts (and later builds) agree.
+
+                    const Real checksum = d.update.norm(d.domain, 1, 0, NUM_STATE);
+
+                    amrex::Print() << std::setw(8) << method << std::setw(9) << riemann_solver
+                                   << std::setw(6) << tile_size << std::setw(9) << nt
+                                   << std::scientific << std::setprecision(4)
+                                   << std::setw(14) << zones / t_ctoprim
+                                   << std::setw(14) << rate
+                                   << std::fixed << std::setprecision(2)
+                                   << std::setw(9) << rate / first_rate
+                                   << std::scientific << std::setprecision(15)
+                                   << std::setw(24) << checksum << "\n";
+                }
+            }
+        }
+    }
+
+    amrex::Finalize();
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include <new>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+#include <AMReX_REAL.H>
+#include <AMReX_Vector.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_BC_TYPES.H>
+
+#include "Castro_F.H"
+
+using namespace amrex;
+
+extern "C"
+{
+   void do_riemann();
+}
+
+int
+main (int   argc,
+      char* argv[])
+{
+
+    amrex::Initialize(argc,argv);
+
+    // the microphysics runtime parameters come from the probin
+
+    std::string probin_file = "probin";
+    const int probin_file_length = probin_file.length();
+    Vector<int> probin_file_name(probin_file_length);
+
+    for (int i = 0; i < probin_file_length; i++)
+        probin_file_name[i] = probin_file[i];
+
+    ca_extern_init(probin_file_name.dataPtr(), &probin_file_length);
+
+    ca_network_init();
+
+    // set up the state indices the same way Castro::variableSetUp does
+
+    const int dm = BL_SPACEDIM;
+
+    int NumSpec, NumAux, NumAdv;
+
+    ca_get_num_spec(&NumSpec);
+    ca_get_num_aux(&NumAux);
+    ca_get_num_adv(&NumAdv);
+
+    int Density, Xmom, Ymom, Zmom, Eden, Eint, Temp;
+    int FirstAdv, FirstSpec, FirstAux;
+
+    int QRHO, QU, QV, QW, QGAME, QPRES, QREINT, QTEMP;
+    int QFA, QFS, QFX;
+
+#include "set_conserved.H"
+
+#include "set_primitive.H"
+
+    // castro.* parameters (cg_maxiter, cg_tol, cg_blend, ...) come
+    // from the inputs file
+
+    ca_set_castro_method_params();
+
+    std::string gravity_type = "none";
+    const int gravity_type_length = gravity_type.length();
+    Vector<int> gravity_type_name(gravity_type_length);
+
+    for (int i = 0; i < gravity_type_length; i++)
+        gravity_type_name[i] = gravity_type[i];
+
+    ca_set_method_params(dm, Density, Xmom, Eden, Eint, Temp,
+                         FirstAdv, FirstSpec, FirstAux,
+                         QRHO, QU, QV, QW,
+                         QGAME, QPRES, QREINT,
+                         QTEMP,
+                         QFA, QFS, QFX,
+                         gravity_type_name.dataPtr(), gravity_type_length);
+
+    // all interior boundaries, so no interface is on a wall
+
+    int physbc[BL_SPACEDIM] = {AMREX_D_DECL(Interior, Interior, Interior)};
+    Real problo[BL_SPACEDIM] = {AMREX_D_DECL(0.0, 0.0, 0.0)};
+    Real probhi[BL_SPACEDIM] = {AMREX_D_DECL(1.0, 1.0, 1.0)};
+    Real center[BL_SPACEDIM] = {AMREX_D_DECL(0.5, 0.5, 0.5)};
+
+    ca_set_problem_params(dm, physbc, physbc,
+                          Interior, Inflow, Outflow, Symmetry, SlipWall, NoSlipWall,
+                          0, problo, probhi, center);
+
+    do_riemann();
+
+    amrex::Finalize();
+
+    return 0;
+}
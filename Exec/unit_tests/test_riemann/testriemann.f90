@@ -0,0 +1,177 @@
+! Compare the Colella & Glaz Riemann solver done one interface at a
+! time (riemann_solver = 1) against the version that works on a pencil
+! of interfaces at a time (riemann_solver = 3).  Both are run through
+! cmpflx on the same set of x-interface states and we report the
+! interfaces/second for each and the largest difference in the fluxes.
+! The two should give identical fluxes, so any difference is an error.
+
+subroutine do_riemann() bind(C)
+
+  use network, only : nspec, naux
+  use eos_type_module, only : eos_t, eos_input_rp
+  use eos_module
+  use amrex_constants_module, only : ZERO, ONE
+  use meth_params_module, only : NQ, NVAR, NQAUX, NGDNV, &
+                                 QRHO, QU, QV, QW, QPRES, QREINT, QGAME, QTEMP, &
+                                 QFS, QFX, QGAMC, QC, QDPDR, QDPDE, &
+                                 riemann_solver, cg_maxiter, cg_tol, cg_blend
+  use riemann_module, only : cmpflx
+  use extern_probin_module, only : nx, ny, nz, nreps, dens_min, dens_max, &
+                                   pres_min, pres_max, vel_max
+
+  use amrex_fort_module, only : rt => amrex_real
+  implicit none
+
+  real(rt)        , allocatable :: q(:,:,:,:), qaux(:,:,:,:)
+  real(rt)        , allocatable :: qm(:,:,:,:,:), qp(:,:,:,:,:)
+  real(rt)        , allocatable :: flx_cg(:,:,:,:), flx_pencil(:,:,:,:)
+  real(rt)        , allocatable :: qgdnv(:,:,:,:), shk(:,:,:)
+
+  integer :: lo(3), hi(3), c_lo(3), c_hi(3), domlo(3), domhi(3)
+  integer :: i, j, k, n, r, ndiff
+
+  real(rt)         :: rnd(3)
+  real(rt)         :: start, finish
+  real(rt)         :: t_cg, t_pencil
+  real(rt)         :: err, fmax
+
+  type (eos_t) :: eos_state
+
+  ! the interfaces we solve on and the zones on either side of them
+
+  domlo = [0, 0, 0]
+  domhi = [nx-1, ny-1, nz-1]
+
+  lo = domlo
+  hi = [nx, ny-1, nz-1]
+
+  c_lo = [-1, 0, 0]
+  c_hi = [nx, ny-1, nz-1]
+
+  allocate(q(c_lo(1):c_hi(1),c_lo(2):c_hi(2),c_lo(3):c_hi(3),NQ))
+  allocate(qaux(c_lo(1):c_hi(1),c_lo(2):c_hi(2),c_lo(3):c_hi(3),NQAUX))
+
+  allocate(qm(lo(1):hi(1),lo(2):hi(2),lo(3):hi(3),NQ,1))
+  allocate(qp(lo(1):hi(1),lo(2):hi(2),lo(3):hi(3),NQ,1))
+
+  allocate(flx_cg(lo(1):hi(1),lo(2):hi(2),lo(3):hi(3),NVAR))
+  allocate(flx_pencil(lo(1):hi(1),lo(2):hi(2),lo(3):hi(3),NVAR))
+  allocate(qgdnv(lo(1):hi(1),lo(2):hi(2),lo(3):hi(3),NGDNV))
+  allocate(shk(lo(1):hi(1),lo(2):hi(2),lo(3):hi(3)))
+
+  shk(:,:,:) = ZERO
+
+  ! random zone states, so neighboring zones can be separated by
+  ! shocks, rarefactions, or nearly nothing
+
+  do k = c_lo(3), c_hi(3)
+     do j = c_lo(2), c_hi(2)
+        do i = c_lo(1), c_hi(1)
+
+           call random_number(rnd)
+
+           eos_state % rho = 10.0e0_rt**(log10(dens_min) + rnd(1)*(log10(dens_max) - log10(dens_min)))
+           eos_state % p   = 10.0e0_rt**(log10(pres_min) + rnd(2)*(log10(pres_max) - log10(pres_min)))
+           eos_state % T   = 1.0e4_rt
+           eos_state % xn  = ONE / nspec
+           eos_state % aux = ZERO
+
+           call eos(eos_input_rp, eos_state)
+
+           q(i,j,k,:) = ZERO
+           q(i,j,k,QRHO) = eos_state % rho
+           q(i,j,k,QU) = vel_max * (2.0e0_rt*rnd(3) - ONE)
+           q(i,j,k,QV) = vel_max * rnd(1)
+           q(i,j,k,QW) = vel_max * rnd(2)
+           q(i,j,k,QPRES) = eos_state % p
+           q(i,j,k,QREINT) = eos_state % rho * eos_state % e
+           q(i,j,k,QGAME) = eos_state % p / (eos_state % rho * eos_state % e) + ONE
+           q(i,j,k,QTEMP) = eos_state % T
+           q(i,j,k,QFS:QFS-1+nspec) = eos_state % xn
+           q(i,j,k,QFX:QFX-1+naux) = eos_state % aux
+
+           qaux(i,j,k,:) = ZERO
+           qaux(i,j,k,QGAMC) = eos_state % gam1
+           qaux(i,j,k,QC) = eos_state % cs
+           qaux(i,j,k,QDPDR) = eos_state % dpdr_e
+           qaux(i,j,k,QDPDE) = eos_state % dpde
+
+        enddo
+     enddo
+  enddo
+
+  ! piecewise constant interface states
+
+  do k = lo(3), hi(3)
+     do j = lo(2), hi(2)
+        do i = lo(1), hi(1)
+           qm(i,j,k,:,1) = q(i-1,j,k,:)
+           qp(i,j,k,:,1) = q(i,j,k,:)
+        enddo
+     enddo
+  enddo
+
+  ! one interface at a time
+
+  riemann_solver = 1
+
+  call cpu_time(start)
+
+  do r = 1, nreps
+     call cmpflx(qm, qp, lo, hi, 1, 1, &
+                 flx_cg, lo, hi, &
+                 qgdnv, lo, hi, &
+                 qaux, c_lo, c_hi, &
+                 shk, lo, hi, &
+                 1, lo, hi, domlo, domhi)
+  enddo
+
+  call cpu_time(finish)
+  t_cg = finish - start
+
+  ! a pencil at a time
+
+  riemann_solver = 3
+
+  call cpu_time(start)
+
+  do r = 1, nreps
+     call cmpflx(qm, qp, lo, hi, 1, 1, &
+                 flx_pencil, lo, hi, &
+                 qgdnv, lo, hi, &
+                 qaux, c_lo, c_hi, &
+                 shk, lo, hi, &
+                 1, lo, hi, domlo, domhi)
+  enddo
+
+  call cpu_time(finish)
+  t_pencil = finish - start
+
+  ! difference in each flux component, relative to the largest
+  ! magnitude of that component
+
+  err = ZERO
+  do n = 1, NVAR
+     fmax = maxval(abs(flx_cg(:,:,:,n)))
+     if (fmax > ZERO) then
+        err = max(err, maxval(abs(flx_pencil(:,:,:,n) - flx_cg(:,:,:,n))) / fmax)
+     endif
+  enddo
+
+  ndiff = count(flx_pencil /= flx_cg)
+
+  print *, 'interfaces per sweep = ', (hi(1)-lo(1)+1)*(hi(2)-lo(2)+1)*(hi(3)-lo(3)+1), &
+           ', repetitions = ', nreps
+  print *, 'cg_maxiter = ', cg_maxiter, ', cg_tol = ', cg_tol, ', cg_blend = ', cg_blend
+  print *, ' '
+  print *, 'interfaces/s (riemanncg)        = ', dble(size(shk)) * nreps / t_cg
+  print *, 'interfaces/s (riemanncg_pencil) = ', dble(size(shk)) * nreps / t_pencil
+  print *, 'max rel. flux difference        = ', err
+  print *, 'flux values that differ         = ', ndiff
+
+  if (ndiff > 0) then
+     print *, 'ERROR: the pencil solver does not give the same fluxes as riemanncg'
+     stop 1
+  endif
+
+end subroutine do_riemann
@@ -18,6 +18,9 @@
 #include <Castro_F.H>
 #include <Derive_F.H>
 #include <Castro_error_F.H>
+#include <Castro_scratch.H>
+#include <Castro_async_io.H>
+#include <Castro_kernel_stats.H>
 #include <AMReX_VisMF.H>
 #include <AMReX_TagBox.H>
 #include <AMReX_FillPatchUtil.H>
@@ -119,6 +122,22 @@ int          Castro::NGDNV         = -1;
 
 Real         Castro::num_zones_advanced = 0.0;
 
+#if defined(REACTIONS) && !defined(SDC)
+Real         Castro::num_burn_recoveries = 0.0;
+int          Castro::num_burn_retries = 0;
+#endif
+
+Real         Castro::comm_time_hidden = 0.0;
+Real         Castro::comm_time_exposed = 0.0;
+
+Real         Castro::retry_snapshot_time = 0.0;
+long         Castro::retry_snapshot_bytes_max = 0;
+
+long         Castro::derive_cache_hits = 0;
+long         Castro::derive_cache_misses = 0;
+long         Castro::derive_cache_epoch = 0;
+bool         Castro::derive_cache_paused = false;
+
 Vector<std::string> Castro::source_names;
 
 int          Castro::MOL_STAGES;
@@ -156,6 +175,8 @@ IntVect      Castro::hydro_tile_size(1024);
 #else
 IntVect      Castro::hydro_tile_size(1024);
 #endif
+IntVect      Castro::ctoprim_tile_size(1024);
+IntVect      Castro::fused_tile_size(1024);
 IntVect      Castro::no_tile_size(1024);
 #elif BL_SPACEDIM == 2
 #ifndef AMREX_USE_CUDA
@@ -163,6 +184,8 @@ IntVect      Castro::hydro_tile_size(1024,16);
 #else
 IntVect      Castro::hydro_tile_size(1024,1024);
 #endif
+IntVect      Castro::ctoprim_tile_size(1024,16);
+IntVect      Castro::fused_tile_size(128,32);
 IntVect      Castro::no_tile_size(1024,1024);
 #else
 #ifndef AMREX_USE_CUDA
@@ -170,6 +193,8 @@ IntVect      Castro::hydro_tile_size(1024,16,16);
 #else
 IntVect      Castro::hydro_tile_size(1024,1024,1024);
 #endif
+IntVect      Castro::ctoprim_tile_size(1024,16,16);
+IntVect      Castro::fused_tile_size(64,16,16);
 IntVect      Castro::no_tile_size(1024,1024,1024);
 #endif
 
@@ -178,7 +203,6 @@ Real         Castro::previousCPUTimeUsed = 0.0;
 
 Real         Castro::startCPUTime = 0.0;
 
-int          Castro::Knapsack_Weight_Type = -1;
 int          Castro::num_state_type = 0;
 
 // Note: Castro::variableSetUp is in Castro_setup.cpp
@@ -186,6 +210,9 @@ int          Castro::num_state_type = 0;
 void
 Castro::variableCleanUp ()
 {
+    // Make sure every plotfile is on disk before we go away.
+    AsyncWriter::finalize();
+
 #ifdef SELF_GRAVITY
   if (gravity != 0) {
     if (verbose > 1 && ParallelDescriptor::IOProcessor()) {
@@ -234,6 +261,10 @@ Castro::variableCleanUp ()
     sponge_finalize();
 #endif
     amrinfo_finalize();
+
+    ScratchArena::finalize();
+
+    KernelStats::finalize();
 }
 
 void
@@ -387,6 +418,74 @@ Castro::read_params ()
 	pp.add("do_ctu", do_ctu);
       }
 
+    if (fused_hydro_tiles == 1 && do_ctu == 0)
+      {
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << "WARNING: fused_hydro_tiles only applies to the CTU method.  Resetting fused_hydro_tiles = 0" << std::endl;
+        fused_hydro_tiles = 0;
+      }
+
+    if (overlap_hydro_comm == 1 && do_ctu == 0)
+      {
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << "WARNING: overlap_hydro_comm only applies to the CTU method.  Resetting overlap_hydro_comm = 0" << std::endl;
+        overlap_hydro_comm = 0;
+      }
+
+    // The burn and the fused hydro sweep need the ghost zones right
+    // away, so there would be nothing to overlap the exchange with.
+    if (overlap_hydro_comm == 1 && fused_hydro_tiles == 1)
+      {
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << "WARNING: overlap_hydro_comm does not apply with fused_hydro_tiles.  Resetting overlap_hydro_comm = 0" << std::endl;
+        overlap_hydro_comm = 0;
+      }
+
+#ifdef REACTIONS
+    if (overlap_hydro_comm == 1 && do_react == 1)
+      {
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << "WARNING: overlap_hydro_comm does not apply with reactions.  Resetting overlap_hydro_comm = 0" << std::endl;
+        overlap_hydro_comm = 0;
+      }
+#endif
+
+#if defined(RADIATION) || defined(SDC) || defined(AMREX_USE_CUDA)
+    if (overlap_hydro_comm == 1)
+      {
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << "WARNING: overlap_hydro_comm is not supported in this build.  Resetting overlap_hydro_comm = 0" << std::endl;
+        overlap_hydro_comm = 0;
+      }
+#endif
+
+#ifdef RADIATION
+    // The radiation solvers fill the ghost zones of the old state during
+    // the advance, so it has to be copied up front.
+    if (retry_lazy_snapshot == 1)
+      {
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << "WARNING: retry_lazy_snapshot is not supported with radiation.  Resetting retry_lazy_snapshot = 0" << std::endl;
+        retry_lazy_snapshot = 0;
+      }
+#endif
+
+#ifdef AMREX_USE_CUDA
+    if (hydro_tile_autotune == 1)
+      {
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << "WARNING: hydro_tile_autotune is not supported with CUDA.  Resetting hydro_tile_autotune = 0" << std::endl;
+        hydro_tile_autotune = 0;
+      }
+#endif
+
+#ifdef RADIATION
+    if (fused_hydro_tiles == 1)
+      {
+        amrex::Error("fused_hydro_tiles is not supported with radiation");
+      }
+#endif
+
     if (hybrid_riemann == 1 && BL_SPACEDIM == 1)
       {
         std::cerr << "hybrid_riemann only implemented in 2- and 3-d\n";
@@ -404,6 +503,13 @@ Castro::read_params ()
     // Make sure not to call refluxing if we're not actually doing any hydro.
     if (do_hydro == 0) do_reflux = 0;
 
+    {
+        int use_custom_knapsack_weights = 0;
+        pp.query("use_custom_knapsack_weights", use_custom_knapsack_weights);
+        if (use_custom_knapsack_weights)
+            amrex::Error("castro.use_custom_knapsack_weights has been replaced by castro.load_balance_by_cost");
+    }
+
     if (max_dt < fixed_dt)
       {
 	std::cerr << "cannot have max_dt < fixed_dt\n";
@@ -454,11 +560,30 @@ Castro::read_params ()
 	for (int i=0; i<BL_SPACEDIM; i++) hydro_tile_size[i] = tilesize[i];
     }
 
+    // The primitive variable conversion starts out with the same tiles
+    // as the hydro update; castro.hydro_tile_autotune picks its own.
+
+    ctoprim_tile_size = hydro_tile_size;
+
+    // The fused CTU path keeps q, qaux and src_q only for the current
+    // tile, so its tiles should be small enough that this scratch
+    // stays resident in cache.  But each tile converts its own
+    // NUM_GROW ghost zones, so thin tiles redo much of the conversion:
+    // 64x8x8 converts 4.5 zones per zone updated, 64x16x16 about 2.5.
+
+    if (pp.queryarr("fused_tile_size", tilesize, 0, BL_SPACEDIM))
+    {
+	for (int i=0; i<BL_SPACEDIM; i++) fused_tile_size[i] = tilesize[i];
+    }
+
 }
 
 Castro::Castro ()
     :
-    prev_state(num_state_type)
+    sborder_exchange_pending(0),
+    prev_state(num_state_type),
+    prev_state_deferred(false),
+    derive_cache_level_epoch(-1)
 {
 }
 
@@ -470,7 +595,10 @@ Castro::Castro (Amr&            papa,
                 Real            time)
     :
     AmrLevel(papa,lev,level_geom,bl,dm,time),
-    prev_state(num_state_type)
+    sborder_exchange_pending(0),
+    prev_state(num_state_type),
+    prev_state_deferred(false),
+    derive_cache_level_epoch(-1)
 {
     buildMetrics();
 
@@ -567,10 +695,6 @@ Castro::Castro (Amr&            papa,
 #endif
 #endif
 
-   if (Knapsack_Weight_Type > 0) {
-    get_new_data(Knapsack_Weight_Type).setVal(1.0);
-   }
-
 #ifdef DIFFUSION
       // diffusion is a static object, only alloc if not already there
       if (diffusion == 0)
@@ -768,6 +892,11 @@ Castro::initMFs()
     lastDtRetryLimited = false;
     lastDtFromRetry = 1.e200;
 
+    if (load_balance_by_cost) {
+        lb_cost.define(grids, dmap, 1, 0);
+        lb_cost.setVal(0.0);
+    }
+
 }
 
 void
@@ -908,10 +1037,6 @@ Castro::initData ()
 #endif
 #endif
 
-   if (Knapsack_Weight_Type > 0) {
-       get_new_data(Knapsack_Weight_Type).setVal(1.0);
-   }
-
 #ifdef MAESTRO_INIT
     MAESTRO_init();
 #else
@@ -1083,6 +1208,20 @@ Castro::init (AmrLevel &old)
 	FillPatch(old, state_MF, state_MF.nGrow(), cur_time, s, 0, state_MF.nComp());
     }
 
+    // If only the distribution of the grids has changed (load_balance),
+    // we can carry the old time data over as well, so that nothing is
+    // lost if a checkpoint is written before the next timestep.
+
+    if (oldlev->grids == grids) {
+	for (int s = 0; s < num_state_type; ++s) {
+	    if (oldlev->state[s].hasOldData()) {
+		state[s].allocOldData();
+		MultiFab& state_MF = get_old_data(s);
+		state_MF.copy(oldlev->get_old_data(s), 0, 0, state_MF.nComp());
+	    }
+	}
+    }
+
 }
 
 //
@@ -1662,6 +1801,11 @@ Castro::post_timestep (int iteration)
 
 #endif
 
+    // The reflux, the average down and the problem hook may all have
+    // changed the state.
+
+    clear_derive_cache();
+
     if (level == 0)
     {
         int nstep = parent->levelSteps(0);
@@ -1695,6 +1839,9 @@ Castro::post_timestep (int iteration)
 #ifdef SELF_GRAVITY
         if (moving_center) write_center();
 #endif
+
+        // All levels have finished this coarse timestep.
+        KernelStats::writeStep(nstep, cumtime);
     }
 
 #ifdef RADIATION
@@ -1824,6 +1971,8 @@ Castro::post_restart ()
     problem_post_restart();
 #endif
 
+    clear_derive_cache();
+
 }
 
 void
@@ -1836,6 +1985,11 @@ Castro::postCoarseTimeStep (Real cumtime)
     if (do_grav)
         gravity->set_mass_offset(cumtime, 0);
 #endif
+
+    // This may replace the level objects, so it must come last.
+
+    if (load_balance_by_cost)
+        load_balance(parent);
 }
 
 void
@@ -1854,10 +2008,18 @@ Castro::check_for_post_regrid (Real time)
 
 	tags.setVal(TagBox::CLEAR);
 
-	for (int i = 0; i < err_list.size(); ++i)
-            apply_tagging_func(tags, TagBox::CLEAR, TagBox::SET, time, i);
+        if (fused_tagging) {
+
+            apply_fused_tagging(tags, TagBox::CLEAR, TagBox::SET, time, time);
+
+        } else {
 
-        apply_problem_tags(tags, TagBox::CLEAR, TagBox::SET, time);
+            for (int i = 0; i < err_list.size(); ++i)
+                apply_tagging_func(tags, TagBox::CLEAR, TagBox::SET, time, i);
+
+            apply_problem_tags(tags, TagBox::CLEAR, TagBox::SET, time);
+
+        }
 
 	// Globally collate the tags.
 
@@ -1996,6 +2158,8 @@ Castro::post_regrid (int lbase,
 
     }
 #endif
+
+    clear_derive_cache();
 }
 
 void
@@ -2088,6 +2252,8 @@ Castro::post_init (Real stop_time)
 
 #endif
 
+    clear_derive_cache();
+
         int nstep = parent->levelSteps(0);
 	Real dtlev = parent->dtLevel(0);
 	Real cumtime = parent->cumTime();
@@ -2296,6 +2462,8 @@ Castro::reflux(int crse_level, int fine_level)
 {
     BL_PROFILE("Castro::reflux()");
 
+    KernelStats::Timer stats_timer(KernelStats::reflux, crse_level, getLevel(crse_level).boxArray(), 2 * NUM_STATE);
+
     BL_ASSERT(fine_level > crse_level);
 
     const Real strt = ParallelDescriptor::second();
@@ -2823,6 +2991,22 @@ Castro::errorEst (TagBoxArray& tags,
     if (post_step_regrid)
 	t = get_state_data(State_Type).curTime();
 
+    KernelStats::Timer stats_timer(KernelStats::tagging, level, grids, NUM_STATE);
+
+    if (fused_tagging) {
+
+        // All of the criteria at once, so the hooks go around all of them.
+
+        problem_pre_tagging_hook(tags, clearval, tagval, t);
+
+        apply_fused_tagging(tags, clearval, tagval, t, time);
+
+        problem_post_tagging_hook(tags, clearval, tagval, t);
+
+        return;
+
+    }
+
     // Apply each of the specified tagging functions.
 
     for (int j = 0; j < num_err_list_default; j++)
@@ -2976,6 +3160,259 @@ Castro::apply_tagging_func(TagBoxArray& tags, int clearval, int tagval, Real tim
 
 
 
+const DeriveRec*
+Castro::state_only_derive_rec (const std::string& name)
+{
+    const DeriveRec* r = derive_lst.get(name);
+
+    if (r == nullptr || r->derFunc3D() == nullptr ||
+        r->deriveType() != IndexType::TheCellType())
+        return nullptr;
+
+    const Box unit_box(IntVect::TheZeroVector(), IntVect::TheUnitVector());
+
+    if (!(r->boxMap()(unit_box) == unit_box))
+        return nullptr;
+
+    for (int k = 0; k < r->numRange(); ++k) {
+        int state_indx, src_comp, num_comp;
+        r->getRange(k, state_indx, src_comp, num_comp);
+        if (state_indx != State_Type)
+            return nullptr;
+    }
+
+#ifdef AMREX_PARTICLES
+    if (name == "particle_count" || name == "total_particle_count")
+        return nullptr;
+#endif
+
+#ifdef NEUTRINO
+    if (name.substr(0,4) == "Neut")
+        return nullptr;
+#endif
+
+    return r;
+}
+
+
+
+void
+Castro::derive_tile (const DeriveRec* r, FArrayBox& der,
+                     const FArrayBox& S, int S_comp, const Box& bx,
+                     Real time, int grid_no)
+{
+    const int*  domain_lo = geom.Domain().loVect();
+    const int*  domain_hi = geom.Domain().hiVect();
+    const Real* dx        = geom.CellSize();
+    const Real  dt        = parent->dtLevel(level);
+
+    // A single range of components can be read straight from the
+    // state; otherwise gather them, in order.
+
+    const FArrayBox* srcfab = &S;
+    int scomp = 0;
+
+    if (r->numRange() == 1) {
+        int state_indx, num_comp;
+        r->getRange(0, state_indx, scomp, num_comp);
+        scomp -= S_comp;
+    } else {
+        FArrayBox& src = ScratchArena::fab(ScratchArena::derive_src, bx, r->numState());
+        int dcomp = 0;
+        for (int k = 0; k < r->numRange(); ++k) {
+            int state_indx, src_comp, num_comp;
+            r->getRange(k, state_indx, src_comp, num_comp);
+            src.copy(S, bx, src_comp - S_comp, bx, dcomp, num_comp);
+            dcomp += num_comp;
+        }
+        srcfab = &src;
+    }
+
+    const RealBox pbx(bx, dx, geom.ProbLo());
+
+    int n_der   = r->numDerive();
+    int n_state = r->numState();
+
+    r->derFunc3D()(der.dataPtr(), ARLIM_3D(der.loVect()), ARLIM_3D(der.hiVect()), &n_der,
+                   srcfab->dataPtr(scomp), ARLIM_3D(srcfab->loVect()), ARLIM_3D(srcfab->hiVect()), &n_state,
+                   ARLIM_3D(bx.loVect()), ARLIM_3D(bx.hiVect()),
+                   ARLIM_3D(domain_lo), ARLIM_3D(domain_hi),
+                   ZFILL(dx), ZFILL(pbx.lo()),
+                   &time, &dt, r->getBC3D(), &level, &grid_no);
+}
+
+
+
+void
+Castro::apply_fused_tagging(TagBoxArray& tags, int clearval, int tagval, Real time, Real prob_time)
+{
+
+    BL_PROFILE("Castro::apply_fused_tagging()");
+
+    const int*  domain_lo = geom.Domain().loVect();
+    const int*  domain_hi = geom.Domain().hiVect();
+    const Real* dx        = geom.CellSize();
+    const Real* prob_lo   = geom.ProbLo();
+
+    const int ncrit = err_list.size();
+
+    // Sort the criteria by where their data comes from: a component of
+    // State_Type, or a cell-centered field derived from State_Type alone
+    // on the same box, which we derive tile by tile from one fill of the
+    // state.  Anything else (e.g. a field that needs the reactions or
+    // radiation data) goes through derive(), as in apply_tagging_func.
+
+    enum { from_state = 0, from_derive_rec, from_derive };
+
+    Vector<int> source(ncrit, from_derive);
+    Vector<int> state_comp(ncrit, 0);
+    Vector<const DeriveRec*> rec(ncrit, nullptr);
+    Vector<std::unique_ptr<MultiFab> > derived(ncrit);
+
+    int ngrow = 0;
+    bool need_fill = false;
+
+    for (int j = 0; j < ncrit; ++j) {
+
+        const std::string& name = err_list[j].name();
+        const int ng = err_list[j].nGrow();
+
+        int index, comp;
+
+        if (isStateVariable(name, index, comp) && index == State_Type) {
+
+            source[j] = from_state;
+            state_comp[j] = comp;
+
+        } else if (const DeriveRec* r = state_only_derive_rec(name)) {
+
+            source[j] = from_derive_rec;
+            rec[j] = r;
+
+        }
+
+        if (source[j] == from_derive) {
+            derived[j] = derive(name, time, ng);
+            BL_ASSERT(derived[j]);
+        } else {
+            ngrow = std::max(ngrow, ng);
+            need_fill = true;
+        }
+
+    }
+
+    MultiFab& S_new = get_new_data(State_Type);
+
+    MultiFab Sfill;
+
+    if (need_fill) {
+        Sfill.define(grids, dmap, NUM_STATE, ngrow);
+        AmrLevel::FillPatch(*this, Sfill, ngrow, time, State_Type, 0, NUM_STATE);
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        Vector<int>  itags;
+
+        for (MFIter mfi(S_new,true); mfi.isValid(); ++mfi)
+        {
+            // tile box
+            const Box&  tilebx  = mfi.tilebox();
+
+            TagBox&     tagfab  = tags[mfi];
+
+            // physical tile box
+            const RealBox& pbx  = RealBox(tilebx,geom.CellSize(),geom.ProbLo());
+
+            // Convert the tags once for all of the criteria.
+            tagfab.get_itags(itags, tilebx);
+
+            // data pointer and index space
+            int*        tptr    = itags.dataPtr();
+            const int*  tlo     = tilebx.loVect();
+            const int*  thi     = tilebx.hiVect();
+            //
+            const Real* xlo     = pbx.lo();
+
+            for (int j = 0; j < ncrit; ++j)
+            {
+                Real*       dat;
+                const int*  dlo;
+                const int*  dhi;
+                int         ncomp;
+
+                if (source[j] == from_state) {
+
+                    FArrayBox& datfab = Sfill[mfi];
+
+                    dat   = datfab.dataPtr(state_comp[j]);
+                    dlo   = datfab.loVect();
+                    dhi   = datfab.hiVect();
+                    ncomp = 1;
+
+                } else if (source[j] == from_derive_rec) {
+
+                    // Derive on the tile, grown by the ghost zones this
+                    // criterion looks at.
+
+                    const Box dbx = amrex::grow(tilebx, err_list[j].nGrow());
+
+                    FArrayBox& der = ScratchArena::fab(ScratchArena::derive_dst, dbx, rec[j]->numDerive());
+
+                    derive_tile(rec[j], der, Sfill[mfi], 0, dbx, time, mfi.index());
+
+                    dat   = der.dataPtr();
+                    dlo   = der.loVect();
+                    dhi   = der.hiVect();
+                    ncomp = der.nComp();
+
+                } else {
+
+                    FArrayBox& datfab = (*derived[j])[mfi];
+
+                    dat   = datfab.dataPtr();
+                    dlo   = datfab.loVect();
+                    dhi   = datfab.hiVect();
+                    ncomp = datfab.nComp();
+
+                }
+
+                err_list[j].errFunc()(tptr, tlo, thi, &tagval,
+                                      &clearval, dat, dlo, dhi,
+                                      tlo, thi, &ncomp, domain_lo, domain_hi,
+                                      dx, xlo, prob_lo, &time, &level);
+            }
+
+            // The problem tags work from the new state, as in
+            // apply_problem_tags.
+
+#ifdef AMREX_DIMENSION_AGNOSTIC
+	    set_problem_tags(ARLIM_3D(tilebx.loVect()), ARLIM_3D(tilebx.hiVect()),
+                             tptr, ARLIM_3D(tlo), ARLIM_3D(thi),
+			     BL_TO_FORTRAN_ANYD(S_new[mfi]),
+			     &tagval, &clearval,
+			     ZFILL(dx), ZFILL(prob_lo), &prob_time, &level);
+#else
+	    set_problem_tags(tilebx.loVect(), tilebx.hiVect(),
+                             tptr, ARLIM(tlo), ARLIM(thi),
+			     BL_TO_FORTRAN(S_new[mfi]),
+			     &tagval, &clearval,
+		             dx, prob_lo, &prob_time, &level);
+#endif
+
+            //
+            // Now update the tags in the TagBox, once.
+            //
+            tagfab.tags_and_untags(itags, tilebx);
+        }
+    }
+
+}
+
+
+
 std::unique_ptr<MultiFab>
 Castro::derive (const std::string& name,
                 Real           time,
@@ -2997,11 +3434,36 @@ Castro::derive (const std::string& name,
   }
 #endif
 
+  const bool use_cache = derive_cache && !derive_cache_paused
+#ifdef AMREX_PARTICLES
+                         && name != "particle_count" && name != "total_particle_count"
+#endif
+                         ;
+
+  if (use_cache) {
+    if (const MultiFab* cached = derive_cache_find(name,time,ngrow)) {
+      std::unique_ptr<MultiFab> mf(new MultiFab(cached->boxArray(), cached->DistributionMap(),
+                                                cached->nComp(), ngrow));
+      MultiFab::Copy(*mf, *cached, 0, 0, mf->nComp(), ngrow);
+      return mf;
+    }
+  }
+
 #ifdef AMREX_PARTICLES
-  return ParticleDerive(name,time,ngrow);
+  auto mf = ParticleDerive(name,time,ngrow);
 #else
-   return AmrLevel::derive(name,time,ngrow);
+  auto mf = AmrLevel::derive(name,time,ngrow);
 #endif
+
+  if (use_cache && mf) {
+    // The caller owns mf and may change it, so keep a copy.
+    std::unique_ptr<MultiFab> keep(new MultiFab(mf->boxArray(), mf->DistributionMap(),
+                                                mf->nComp(), mf->nGrow()));
+    MultiFab::Copy(*keep, *mf, 0, 0, mf->nComp(), mf->nGrow());
+    derive_cache_store(name, time, std::move(keep), false);
+  }
+
+  return mf;
 }
 
 void
@@ -3029,6 +3491,145 @@ Castro::derive (const std::string& name,
     AmrLevel::derive(name,time,mf,dcomp);
 }
 
+void
+Castro::clear_derive_cache ()
+{
+    ++derive_cache_epoch;
+
+    // Free the memory now rather than at the next lookup, which may
+    // not come until the next plotfile.
+
+    Vector<std::unique_ptr<AmrLevel> >& levels = parent->getAmrLevels();
+
+    for (int lev = 0; lev <= parent->finestLevel() && lev < levels.size(); ++lev) {
+        if (levels[lev]) {
+            Castro& c = getLevel(lev);
+            c.derive_cache_list.clear();
+            c.derive_cache_level_epoch = derive_cache_epoch;
+        }
+    }
+}
+
+const MultiFab*
+Castro::derive_cache_find (const std::string& name,
+                           Real               time,
+                           int                ngrow,
+                           bool               use)
+{
+    // Everything derived before the last change of the state is stale.
+
+    if (derive_cache_level_epoch != derive_cache_epoch) {
+        derive_cache_list.clear();
+        derive_cache_level_epoch = derive_cache_epoch;
+        return nullptr;
+    }
+
+    for (auto& d : derive_cache_list) {
+        if (d.name == name && d.time == time && d.mf->nGrow() >= ngrow) {
+            // The first use of a field from derive_batch is the one it
+            // was derived for, not a saving.
+            if (use) {
+                if (d.batched)
+                    d.batched = false;
+                else
+                    derive_cache_hits += 1;
+            }
+            return d.mf.get();
+        }
+    }
+
+    return nullptr;
+}
+
+void
+Castro::derive_cache_store (const std::string&          name,
+                            Real                        time,
+                            std::unique_ptr<MultiFab>&& mf,
+                            bool                        batched)
+{
+    derive_cache_misses += 1;
+
+    // Replace a copy with fewer ghost zones, if there is one.
+
+    for (auto& d : derive_cache_list) {
+        if (d.name == name && d.time == time) {
+            d.mf = std::move(mf);
+            d.batched = batched;
+            return;
+        }
+    }
+
+    derive_cache_list.push_back({name, time, std::move(mf), batched});
+}
+
+void
+Castro::derive_batch (const std::list<std::string>& names,
+                      Real                          time,
+                      int                           ngrow)
+{
+    if (!derive_cache || derive_cache_paused) return;
+
+    BL_PROFILE("Castro::derive_batch()");
+
+    // Collect the fields we don't have yet that can be derived tile by
+    // tile from State_Type alone, and the components they read.
+
+    Vector<std::string> todo;
+    Vector<const DeriveRec*> recs;
+
+    int lo = NUM_STATE;
+    int hi = 0;
+
+    for (const auto& name : names) {
+
+        if (derive_cache_find(name, time, ngrow, false) != nullptr)
+            continue;
+
+        const DeriveRec* r = state_only_derive_rec(name);
+
+        if (r == nullptr)
+            continue;
+
+        for (int k = 0; k < r->numRange(); ++k) {
+            int state_indx, src_comp, num_comp;
+            r->getRange(k, state_indx, src_comp, num_comp);
+            lo = std::min(lo, src_comp);
+            hi = std::max(hi, src_comp + num_comp);
+        }
+
+        todo.push_back(name);
+        recs.push_back(r);
+
+    }
+
+    // With only one field there is no fill to share; derive() does it.
+
+    if (todo.size() < 2) return;
+
+    const int nfld = todo.size();
+
+    MultiFab Sfill(grids, dmap, hi - lo, ngrow);
+    AmrLevel::FillPatch(*this, Sfill, ngrow, time, State_Type, lo, hi - lo);
+
+    Vector<std::unique_ptr<MultiFab> > derived(nfld);
+    for (int f = 0; f < nfld; ++f)
+        derived[f].reset(new MultiFab(grids, dmap, recs[f]->numDerive(), ngrow));
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(Sfill, true); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.growntilebox();
+
+        for (int f = 0; f < nfld; ++f)
+            derive_tile(recs[f], (*derived[f])[mfi], Sfill[mfi], lo, bx, time, mfi.index());
+    }
+
+    for (int f = 0; f < nfld; ++f)
+        derive_cache_store(todo[f], time, std::move(derived[f]), true);
+}
+
 void
 Castro::amrinfo_init ()
 {
@@ -3549,6 +4150,8 @@ Castro::expand_state(MultiFab& S, Real time, int iclean, int ng)
 {
   BL_PROFILE("Castro::expand_state()");
 
+  KernelStats::Timer stats_timer(KernelStats::fillpatch, level, grids, 2 * NUM_STATE);
+
   // S is the multifab we are filling with State_Type StateData,
   // including a ghost cell fill at the end.  Before we do the fill,
   // we do a clean_state on the State_Type data.  iclean = 0 means
@@ -3574,6 +4177,82 @@ Castro::expand_state(MultiFab& S, Real time, int iclean, int ng)
   AmrLevel::FillPatch(*this, S, ng, time, State_Type, 0, NUM_STATE);
 }
 
+// The same fill as expand_state(Sborder, time, 0, NUM_GROW), for level 0,
+// split in two so the ghost zone exchange can be overlapped with other
+// work.  On level 0 FillPatch is just a copy, a FillBoundary and the
+// physical boundary conditions, so doing these separately gives the
+// same Sborder.
+
+void
+Castro::start_sborder_exchange(Real time)
+{
+  BL_PROFILE("Castro::start_sborder_exchange()");
+
+  KernelStats::Timer stats_timer(KernelStats::fillpatch, level, grids, 2 * NUM_STATE);
+
+  BL_ASSERT(level == 0);
+  BL_ASSERT(Sborder.nGrow() == NUM_GROW);
+
+  clean_state(0, 0);
+
+  MultiFab::Copy(Sborder, get_old_data(State_Type), 0, 0, NUM_STATE, 0);
+
+  sborder_exchange_time = time;
+  sborder_exchange_start = ParallelDescriptor::second();
+
+  Sborder.FillBoundary_nowait(geom.periodicity());
+
+  sborder_exchange_pending = 1;
+}
+
+void
+Castro::finish_sborder_exchange()
+{
+  if (!sborder_exchange_pending) return;
+
+  BL_PROFILE("Castro::finish_sborder_exchange()");
+
+  // The rest of the fill started by start_sborder_exchange, which
+  // already counted the zones.
+  KernelStats::Timer stats_timer(KernelStats::fillpatch, level, 0L, 0);
+
+  const Real strt = ParallelDescriptor::second();
+
+  Sborder.FillBoundary_finish();
+
+  const Real end = ParallelDescriptor::second();
+
+  sborder_exchange_pending = 0;
+
+  StateDataPhysBCFunct physbcf(state[State_Type], 0, geom);
+  physbcf.FillBoundary(Sborder, 0, NUM_STATE, sborder_exchange_time);
+
+  // Whatever we did between the start and the finish was overlapped
+  // with the exchange; the wait here was not.
+
+  Real hidden  = strt - sborder_exchange_start;
+  Real exposed = end - strt;
+
+  comm_time_hidden  += hidden;
+  comm_time_exposed += exposed;
+
+  if (verbose > 1)
+  {
+      const int IOProc = ParallelDescriptor::IOProcessorNumber();
+
+#ifdef BL_LAZY
+      Lazy::QueueReduction( [=] () mutable {
+#endif
+      ParallelDescriptor::ReduceRealMax(hidden, IOProc);
+      ParallelDescriptor::ReduceRealMax(exposed, IOProc);
+      amrex::Print() << "Castro::finish_sborder_exchange() time overlapped = " << hidden
+                     << ", time waited = " << exposed << std::endl;
+#ifdef BL_LAZY
+      });
+#endif
+  }
+}
+
 
 void
 Castro::check_for_nan(MultiFab& state, int check_ghost)
@@ -1,6 +1,7 @@
 
 #include "Castro.H"
 #include "Castro_F.H"
+#include "Castro_scratch.H"
 
 #ifdef RADIATION
 #include "Radiation.H"
@@ -198,6 +199,9 @@ Castro::do_advance (Real time,
 #ifndef SDC
     // this operates on Sborder (which is initially S_old).  The result
     // of the reactions is added directly back to Sborder.
+    if (do_react)
+        finish_sborder_exchange();
+
     strang_react_first_half(prev_time, 0.5 * dt);
 #endif
 #endif
@@ -205,6 +209,9 @@ Castro::do_advance (Real time,
     // Initialize the new-time data. This copy needs to come after the
     // reactions.
 
+    if (S_new.nGrow() > 0)
+        finish_sborder_exchange();
+
     MultiFab::Copy(S_new, Sborder, 0, 0, NUM_STATE, S_new.nGrow());
 
 #ifdef REACTIONS
@@ -237,6 +244,8 @@ Castro::do_advance (Real time,
 
     if (apply_sources()) {
 
+      finish_sborder_exchange();
+
       do_old_sources(old_source, Sborder, prev_time, dt, amr_iteration, amr_ncycle);
 
       int is_new=1;
@@ -260,23 +269,47 @@ Castro::do_advance (Real time,
 
     if (do_hydro)
     {
-      // Construct the primitive variables.
-      cons_to_prim(time);
+      if (fused_hydro_tiles) {
 
-      // Check for CFL violations.
-      check_for_cfl_violation(dt);
+        finish_sborder_exchange();
 
-      // If we detect one, return immediately.
-      if (cfl_violation && hard_cfl_limit)
-          return dt;
+        // Construct the primitive variables, check the CFL condition
+        // and build the hydro source in a single sweep over the tiles.
+        construct_fused_hydro_source(time, dt);
+
+        // The update is not applied if we detected a CFL violation.
+        if (cfl_violation && hard_cfl_limit)
+            return dt;
+
+      } else {
+
+        // Construct the primitive variables.  If the Sborder ghost
+        // zones are still being exchanged, this only does the valid
+        // zones, and construct_hydro_source does the rest once the
+        // exchange is done.
+        cons_to_prim(time);
+
+        // Check for CFL violations.
+        check_for_cfl_violation(dt);
+
+        // If we detect one, return immediately.
+        if (cfl_violation && hard_cfl_limit) {
+            finish_sborder_exchange();
+            return dt;
+        }
+
+        construct_hydro_source(time, dt);
+
+      }
 
-      construct_hydro_source(time, dt);
       int is_new=1;
       apply_source_to_state(is_new, S_new, hydro_source, dt);
     }
 
 
     // Sync up state after old sources and hydro source.
+    finish_sborder_exchange();
+
     int is_new=1;
     frac_change = clean_state(is_new, Sborder, S_new.nGrow());
 
@@ -632,9 +665,19 @@ Castro::initialize_do_advance(Real time, Real dt, int amr_iteration, int amr_ncy
 
     if (do_ctu) {
       // for the CTU unsplit method, we always start with the old state
-      Sborder.define(grids, dmap, NUM_STATE, NUM_GROW);
+      define_work_mf(Sborder, NUM_STATE, NUM_GROW);
       const Real prev_time = state[State_Type].prevTime();
-      expand_state(Sborder, prev_time, 0, NUM_GROW);
+
+      // On level 0, we can leave the exchange of the ghost zones
+      // running while we do the work that only needs the valid zones.
+      // do_advance waits for it as soon as the ghost zones are needed.
+      // The old-time sources need them before the hydro, so this is
+      // only worth doing when there are none.
+
+      if (overlap_hydro_comm && level == 0 && !apply_sources())
+          start_sborder_exchange(prev_time);
+      else
+          expand_state(Sborder, prev_time, 0, NUM_GROW);
 
     } else {
       // for Method of lines, our initialization of Sborder depends on
@@ -643,7 +686,7 @@ Castro::initialize_do_advance(Real time, Real dt, int amr_iteration, int amr_ncy
       if (mol_iteration == 0) {
 
 	// first MOL stage
-	Sborder.define(grids, dmap, NUM_STATE, NUM_GROW);
+	define_work_mf(Sborder, NUM_STATE, NUM_GROW);
 	const Real prev_time = state[State_Type].prevTime();
 	expand_state(Sborder, prev_time, 0, NUM_GROW);
 
@@ -667,7 +710,7 @@ Castro::initialize_do_advance(Real time, Real dt, int amr_iteration, int amr_ncy
         int is_new=1;
         clean_state(is_new, S_new.nGrow());
 
-	Sborder.define(grids, dmap, NUM_STATE, NUM_GROW);
+	define_work_mf(Sborder, NUM_STATE, NUM_GROW);
 	const Real new_time = state[State_Type].curTime();
 	expand_state(Sborder, new_time, 1, NUM_GROW);
 
@@ -689,12 +732,43 @@ Castro::finalize_do_advance(Real time, Real dt, int amr_iteration, int amr_ncycl
     }
 #endif
 
-    Sborder.clear();
+    if (!persistent_hydro_buffers)
+        Sborder.clear();
 
 }
 
 
 
+void
+Castro::define_work_mf(MultiFab& mf, int ncomp, int ngrow)
+{
+    // With castro.persistent_hydro_buffers, keep the array from the
+    // last advance if it is still on our grids.  The callers fill or
+    // zero it anyway, as they would a newly defined one.
+
+    if (persistent_hydro_buffers &&
+        mf.nComp() == ncomp && mf.nGrow() == ngrow &&
+        mf.boxArray() == grids && mf.DistributionMap() == dmap)
+        return;
+
+    mf.clear();
+    mf.define(grids, dmap, ncomp, ngrow);
+
+    // Since this array will be around for a while, touch it first from
+    // the thread that works on each tile in the hydro loops, so its
+    // pages end up on that thread's NUMA node.
+
+    if (persistent_hydro_buffers) {
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for (MFIter mfi(mf, hydro_tile_size); mfi.isValid(); ++mfi)
+            mf[mfi].setVal(0.0, mfi.growntilebox(), 0, ncomp);
+    }
+}
+
+
+
 void
 Castro::initialize_advance(Real time, Real dt, int amr_iteration, int amr_ncycle)
 {
@@ -710,6 +784,16 @@ Castro::initialize_advance(Real time, Real dt, int amr_iteration, int amr_ncycle
 
     keep_prev_state = false;
 
+    // The state is about to change, so nothing derived from it before
+    // is good any more, and nothing derived during the advance is kept.
+
+    clear_derive_cache();
+    derive_cache_paused = true;
+
+    // Count the scratch allocations made over this advance.
+
+    ScratchArena::resetCounters();
+
     // Reset the retry timestep information.
 
     lastDtRetryLimited = 0;
@@ -772,8 +856,8 @@ Castro::initialize_advance(Real time, Real dt, int amr_iteration, int amr_ncycle
     if (do_radiation)
         radiation->pre_timestep(level);
 
-    Erborder.define(grids, dmap, Radiation::nGroups, NUM_GROW);
-    lamborder.define(grids, dmap, Radiation::nGroups, NUM_GROW);
+    define_work_mf(Erborder, Radiation::nGroups, NUM_GROW);
+    define_work_mf(lamborder, Radiation::nGroups, NUM_GROW);
 #endif
 
 #ifdef SELF_GRAVITY
@@ -805,7 +889,7 @@ Castro::initialize_advance(Real time, Real dt, int amr_iteration, int amr_ncycle
     // the new-time sources, so that we can compute the time
     // derivative of the source terms.
 
-    sources_for_hydro.define(grids, dmap, NUM_STATE, NUM_GROW);
+    define_work_mf(sources_for_hydro, NUM_STATE, NUM_GROW);
     sources_for_hydro.setVal(0.0, NUM_GROW);
 
 #ifndef SDC
@@ -858,45 +942,61 @@ Castro::initialize_advance(Real time, Real dt, int amr_iteration, int amr_ncycle
     for (int k = 0; k < num_state_type; ++k)
         prev_state[k].reset(new StateData());
 
+    prev_state_deferred = false;
+
     // Make a copy of the MultiFabs in the old and new state data in case we may do a retry.
 
     if (use_retry || do_subcycle) {
 
-      // Store the old and new time levels.
+      const Real strt_time = ParallelDescriptor::second();
+
+      // Store the old and new time levels.  With the lazy snapshot,
+      // State_Type waits until save_deferred_prev_state.
 
       for (int k = 0; k < num_state_type; k++) {
-        *prev_state[k] = state[k];
+        if (retry_lazy_snapshot && k == State_Type)
+          prev_state_deferred = true;
+        else
+          *prev_state[k] = state[k];
       }
 
+      retry_snapshot_time += ParallelDescriptor::second() - strt_time;
+      retry_snapshot_bytes_max = std::max(retry_snapshot_bytes_max, prev_state_bytes());
+
     }
 
     // This array holds the hydrodynamics update.
 
-    hydro_source.define(grids,dmap,NUM_STATE,0);
+    define_work_mf(hydro_source, NUM_STATE, 0);
 
 
 
-    // Allocate space for the primitive variables.
+    // Allocate space for the primitive variables.  The fused CTU
+    // path builds these per tile, so it does not need them.
 
-    q.define(grids, dmap, NQ, NUM_GROW);
-    q.setVal(0.0);
-    qaux.define(grids, dmap, NQAUX, NUM_GROW);
-    if (do_ctu)
-      src_q.define(grids, dmap, QVAR, NUM_GROW);
+    if (!fused_hydro_tiles) {
+      define_work_mf(q, NQ, NUM_GROW);
+      q.setVal(0.0);
+      define_work_mf(qaux, NQAUX, NUM_GROW);
+      if (do_ctu)
+        define_work_mf(src_q, QVAR, NUM_GROW);
+    }
     if (fourth_order) 
-      q_bar.define(grids, dmap, NQ, NUM_GROW);
+      define_work_mf(q_bar, NQ, NUM_GROW);
 
     if (!do_ctu) {
       // if we are not doing CTU advection, then we are doing a method
       // of lines, and need storage for hte intermediate stages
       k_mol.resize(MOL_STAGES);
       for (int n = 0; n < MOL_STAGES; ++n) {
-	k_mol[n].reset(new MultiFab(grids, dmap, NUM_STATE, 0));
+	if (!k_mol[n])
+	  k_mol[n].reset(new MultiFab());
+	define_work_mf(*k_mol[n], NUM_STATE, 0);
 	k_mol[n]->setVal(0.0);
       }
 
       // for the post-burn state
-      Sburn.define(grids, dmap, NUM_STATE, 0);
+      define_work_mf(Sburn, NUM_STATE, 0);
     }
 
     // Zero out the current fluxes.
@@ -944,33 +1044,105 @@ Castro::finalize_advance(Real time, Real dt, int amr_iteration, int amr_ncycle)
 
     Real cur_time = state[State_Type].curTime();
 
-    hydro_source.clear();
+    // With castro.persistent_hydro_buffers, the work arrays stay
+    // allocated for the next advance on this level.
 
-    q.clear();
-    qaux.clear();
-    if (do_ctu)
-      src_q.clear();
-    if (fourth_order)
-      q_bar.clear();
+    if (!persistent_hydro_buffers) {
+
+      hydro_source.clear();
+
+      q.clear();
+      qaux.clear();
+      if (do_ctu)
+        src_q.clear();
+      if (fourth_order)
+        q_bar.clear();
 
 #ifdef RADIATION
-    Erborder.clear();
-    lamborder.clear();
+      Erborder.clear();
+      lamborder.clear();
 #endif
 
-    sources_for_hydro.clear();
+      sources_for_hydro.clear();
 
-    if (!keep_prev_state)
-        amrex::FillNull(prev_state);
+      if (!do_ctu) {
+        k_mol.clear();
+        Sburn.clear();
+      }
 
-    if (!do_ctu) {
-      k_mol.clear();
-      Sburn.clear();
     }
 
+    if (!keep_prev_state) {
+        amrex::FillNull(prev_state);
+        prev_state_deferred = false;
+    }
+
+    clear_derive_cache();
+    derive_cache_paused = false;
+
     // Record how many zones we have advanced.
 
     num_zones_advanced += grids.numPts() / getLevel(0).grids.numPts();
+
+    // Report how often the tile loops had to go to the heap for their
+    // temporaries.  This should be zero once the largest tile on the
+    // rank has been seen.
+
+    if (verbose > 1) {
+        long scratch_allocs = ScratchArena::numAllocations();
+        long scratch_bytes  = ScratchArena::bytesReserved();
+
+        ParallelDescriptor::ReduceLongSum(scratch_allocs);
+        ParallelDescriptor::ReduceLongMax(scratch_bytes);
+
+        amrex::Print() << "  Scratch arena on level " << level << ": "
+                       << scratch_allocs << " heap allocations this step, "
+                       << scratch_bytes << " bytes reserved (max over ranks)" << std::endl;
+    }
+}
+
+
+
+void
+Castro::save_deferred_prev_state()
+{
+    if (!prev_state_deferred) return;
+
+    const Real strt_time = ParallelDescriptor::second();
+
+    // This also copies the new data of this attempt, which nothing
+    // needs, but it keeps prev_state a complete StateData.
+
+    *prev_state[State_Type] = state[State_Type];
+
+    prev_state_deferred = false;
+
+    retry_snapshot_time += ParallelDescriptor::second() - strt_time;
+    retry_snapshot_bytes_max = std::max(retry_snapshot_bytes_max, prev_state_bytes());
+}
+
+
+
+long
+Castro::prev_state_bytes() const
+{
+    long bytes = 0;
+
+    for (int k = 0; k < num_state_type; k++) {
+
+        if (!prev_state[k]) continue;
+
+        if (prev_state[k]->hasOldData())
+            for (MFIter mfi(prev_state[k]->oldData()); mfi.isValid(); ++mfi)
+                bytes += prev_state[k]->oldData()[mfi].nBytes();
+
+        if (prev_state[k]->hasNewData())
+            for (MFIter mfi(prev_state[k]->newData()); mfi.isValid(); ++mfi)
+                bytes += prev_state[k]->newData()[mfi].nBytes();
+
+    }
+
+    return bytes;
 }
 
 
@@ -1042,6 +1214,11 @@ Castro::retry_advance(Real& time, Real dt, int amr_iteration, int amr_ncycle)
 
         do_retry = true;
 
+#if defined(REACTIONS) && !defined(SDC)
+        if (burn_success != 1)
+            num_burn_retries += 1;
+#endif
+
         dt_subcycle = std::min(dt, dt_subcycle) * retry_subcycle_factor;
 
         if (verbose && ParallelDescriptor::IOProcessor()) {
@@ -1051,7 +1228,11 @@ Castro::retry_advance(Real& time, Real dt, int amr_iteration, int amr_ncycle)
             std::cout << std::endl;
         }
 
-        // Restore the original values of the state data.        
+        // Restore the original values of the state data.  The old
+        // State_Type data has not been changed yet, so if we didn't
+        // copy it up front, this is the time.
+
+        save_deferred_prev_state();
 
         for (int k = 0; k < num_state_type; k++) {
 
@@ -1213,6 +1394,11 @@ Castro::subcycle_advance(const Real time, const Real dt, int amr_iteration, int
                 apply_source_term_predictor();
 #endif
 
+            // The swap overwrites the original old data, which we need
+            // at the end of the subcycles.
+
+            save_deferred_prev_state();
+
             swap_state_time_levels(0.0);
 
 #ifdef SELF_GRAVITY
@@ -0,0 +1,302 @@
+#include "Castro_async_io.H"
+
+#include <AMReX_Utility.H>
+#include <AMReX_ParallelDescriptor.H>
+
+#include <streambuf>
+
+using namespace amrex;
+
+std::deque<AsyncWriter::Job> AsyncWriter::jobs;
+std::deque<AsyncWriter::Header> AsyncWriter::headers;
+std::thread AsyncWriter::worker;
+std::mutex AsyncWriter::mtx;
+std::condition_variable AsyncWriter::cv;
+
+long AsyncWriter::staged_bytes = 0;
+long AsyncWriter::max_staged_bytes = 0;
+long AsyncWriter::last_seq = 0;
+long AsyncWriter::done_seq = 0;
+bool AsyncWriter::running = false;
+bool AsyncWriter::stop = false;
+std::string AsyncWriter::failed_file;
+
+namespace {
+
+    //
+    // A stream buffer that keeps count of what is written to it and
+    // throws the bytes away.  VisMF asks for the file offset with
+    // tellp, so we answer that too.
+    //
+    class CountingBuffer : public std::streambuf
+    {
+    public:
+        std::streamsize count = 0;
+    protected:
+        virtual std::streamsize xsputn (const char*, std::streamsize n) override
+        {
+            count += n;
+            return n;
+        }
+        virtual int_type overflow (int_type c) override
+        {
+            if (!traits_type::eq_int_type(c, traits_type::eof())) ++count;
+            return traits_type::not_eof(c);
+        }
+        virtual pos_type seekoff (off_type off, std::ios_base::seekdir dir,
+                                  std::ios_base::openmode) override
+        {
+            if (off == 0 && dir == std::ios_base::cur) return pos_type(count);
+            return pos_type(off_type(-1));
+        }
+    };
+
+}
+
+void
+AsyncWriter::initialize (long max_bytes)
+{
+    if (running) return;
+
+    max_staged_bytes = max_bytes;
+    staged_bytes = 0;
+    last_seq = 0;
+    done_seq = 0;
+    stop = false;
+    failed_file.clear();
+
+    worker = std::thread(&AsyncWriter::work);
+    running = true;
+}
+
+void
+AsyncWriter::finalize ()
+{
+    if (!running) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stop = true;
+    }
+    cv.notify_all();
+
+    worker.join();
+    running = false;
+
+    checkFailure();
+
+    ParallelDescriptor::Barrier();
+
+    writeHeaders(last_seq);
+}
+
+void
+AsyncWriter::write (std::unique_ptr<MultiFab>&& mf, const std::string& mf_name)
+{
+    BL_PROFILE("AsyncWriter::write()");
+
+    BL_ASSERT(running);
+
+    checkFailure();
+
+    //
+    // Write the headers of the earlier MultiFabs that every rank has
+    // finished with.
+    //
+    long done;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        done = done_seq;
+    }
+    ParallelDescriptor::ReduceLongMin(done, ParallelDescriptor::IOProcessorNumber());
+
+    writeHeaders(done);
+
+    const long seq = ++last_seq;
+
+    //
+    // The collective part: the header min/max and the FAB offsets.
+    //
+    VisMF::Header hdr(*mf, VisMF::OneFilePerCPU, VisMF::Header::Version_v1, true);
+
+    const std::string file_name =
+        amrex::Concatenate(mf_name + VisMF::FabFileSuffix, ParallelDescriptor::MyProc(), 5);
+
+    Vector<long> offsets(mf->size(), 0);
+    long nbytes = 0;
+
+    {
+        CountingBuffer cb;
+        std::ostream counter(&cb);
+        long bytes = 0;
+
+        for (int idx : mf->IndexArray()) {
+            offsets[idx] = VisMF::Write((*mf)[idx], file_name, counter, bytes).m_head;
+            nbytes += (*mf)[idx].nBytes();
+        }
+    }
+
+    ParallelDescriptor::ReduceLongSum(offsets.dataPtr(), offsets.size(),
+                                      ParallelDescriptor::IOProcessorNumber());
+
+    //
+    // Open the header and data files now, while the directory is certain
+    // to be there under this name -- Amr may rename the plotfile
+    // directory once it has written its own headers.  The header is
+    // kept on the I/O processor and written once the data is complete.
+    //
+    if (ParallelDescriptor::IOProcessor()) {
+        const DistributionMapping& dm = mf->DistributionMap();
+        const std::string base_name = VisMF::BaseName(mf_name) + VisMF::FabFileSuffix;
+        for (int i = 0; i < mf->size(); ++i)
+            hdr.m_fod[i] = VisMF::FabOnDisk(amrex::Concatenate(base_name, dm[i], 5), offsets[i]);
+
+        Header h;
+        h.hdr = hdr;
+        h.file_name = mf_name + VisMF::MultiFabHdrFileSuffix;
+        h.seq = seq;
+        h.ofs.reset(new std::ofstream);
+        h.ofs->open(h.file_name.c_str(), std::ios::out | std::ios::trunc);
+        if (!h.ofs->good())
+            amrex::FileOpenFailed(h.file_name);
+
+        headers.push_back(std::move(h));
+    }
+
+    std::unique_ptr<std::ofstream> ofs;
+
+    if (!mf->IndexArray().empty()) {
+        ofs.reset(new std::ofstream);
+        ofs->open(file_name.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!ofs->good())
+            amrex::FileOpenFailed(file_name);
+    }
+
+    //
+    // Back-pressure: wait until the new data fits under the staging limit.
+    // We always let one job through, however large, so we can't deadlock.
+    // A rank with no FABs still queues an empty job, so its done_seq
+    // moves on in step with the others.
+    //
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [nbytes] { return jobs.empty() ||
+                                        staged_bytes + nbytes <= max_staged_bytes; });
+
+        Job job;
+        job.mf = std::move(mf);
+        job.ofs = std::move(ofs);
+        job.file_name = file_name;
+        job.nbytes = nbytes;
+        job.seq = seq;
+
+        jobs.push_back(std::move(job));
+        staged_bytes += nbytes;
+    }
+    cv.notify_all();
+}
+
+void
+AsyncWriter::wait ()
+{
+    if (!running) return;
+
+    BL_PROFILE("AsyncWriter::wait()");
+
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [] { return jobs.empty(); });
+    }
+
+    checkFailure();
+
+    ParallelDescriptor::Barrier();
+
+    writeHeaders(last_seq);
+}
+
+long
+AsyncWriter::bytesStaged ()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return staged_bytes;
+}
+
+void
+AsyncWriter::work ()
+{
+    for (;;) {
+
+        Job* job;
+
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [] { return stop || !jobs.empty(); });
+            if (jobs.empty()) return;
+
+            // push_back on a deque does not move the existing elements,
+            // so this stays good while the main thread adds jobs.
+            job = &jobs.front();
+        }
+
+        bool ok = true;
+
+        if (job->ofs) {
+            const MultiFab& mf = *job->mf;
+            std::ofstream& os = *job->ofs;
+
+            long bytes = 0;
+            for (int idx : mf.IndexArray())
+                VisMF::Write(mf[idx], job->file_name, os, bytes);
+
+            os.flush();
+            ok = os.good();
+            os.close();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!ok && failed_file.empty()) failed_file = job->file_name;
+            staged_bytes -= job->nbytes;
+            done_seq = job->seq;
+            jobs.pop_front();
+        }
+        cv.notify_all();
+
+    }
+}
+
+//
+// Write the pending headers of the MultiFabs up to number done, whose
+// data every rank has finished writing.
+//
+void
+AsyncWriter::writeHeaders (long done)
+{
+    if (!ParallelDescriptor::IOProcessor()) return;
+
+    while (!headers.empty() && headers.front().seq <= done) {
+
+        Header& h = headers.front();
+
+        *h.ofs << h.hdr;
+        h.ofs->flush();
+        if (!h.ofs->good())
+            amrex::Error("AsyncWriter: failed writing " + h.file_name);
+        h.ofs->close();
+
+        headers.pop_front();
+    }
+}
+
+void
+AsyncWriter::checkFailure ()
+{
+    std::string f;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        f = failed_file;
+    }
+    if (!f.empty())
+        amrex::Error("AsyncWriter: failed writing " + f);
+}
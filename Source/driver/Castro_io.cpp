@@ -12,6 +12,8 @@
 #include "Castro.H"
 #include "Castro_F.H"
 #include "Castro_io.H"
+#include "Castro_async_io.H"
+#include "Castro_tile_tuner.H"
 #include <AMReX_ParmParse.H>
 
 #ifdef RADIATION
@@ -274,6 +276,17 @@ Castro::restart (Amr&     papa,
 
     }
 
+    if (hydro_tile_autotune && level == 0)
+    {
+
+      // use the tile sizes picked in the run we are restarting from,
+      // if it had them, instead of tuning again
+      if (TileTuner::read(parent->theRestartFile(), hydro_tile_size, ctoprim_tile_size))
+	amrex::Print() << "... tile size autotune: using hydro " << hydro_tile_size
+		       << " and ctoprim " << ctoprim_tile_size << " from the checkpoint" << std::endl;
+
+    }
+
     if (level == 0)
     {
 	// get problem-specific stuff -- note all processors do this,
@@ -500,6 +513,11 @@ Castro::checkPoint(const std::string& dir,
                    VisMF::How     how,
                    bool dump_old_default)
 {
+  // Let any plotfiles still being written finish first, so everything
+  // older than a checkpoint is complete on disk.
+  if (level == 0 && async_plotfiles)
+    AsyncWriter::wait();
+
   AmrLevel::checkPoint(dir, os, how, dump_old);
 
 #ifdef RADIATION
@@ -567,6 +585,13 @@ Castro::checkPoint(const std::string& dir,
 
 	}
 
+	if (hydro_tile_autotune) {
+
+	    // store the tile sizes the autotuner picked
+	    TileTuner::write(dir, hydro_tile_size, ctoprim_tile_size);
+
+	}
+
 	{
 	    // store any problem-specific stuff
 	    char * dir_for_pass = new char[dir.size() + 1];
@@ -697,6 +722,7 @@ Castro::writeJobInfo (const std::string& dir)
 #endif
   jobInfoFile << "\n";
   jobInfoFile << "hydro tile size:         " << hydro_tile_size << "\n";
+  jobInfoFile << "ctoprim tile size:       " << ctoprim_tile_size << "\n";
 
   jobInfoFile << "\n";
   jobInfoFile << "CPU time used since start of simulation (CPU-hours): " <<
@@ -1117,7 +1143,7 @@ Castro::plotFileOutput(const std::string& dir,
     // but a derived variable is allowed to have multiple components.
     int       cnt   = 0;
     const int nGrow = 0;
-    MultiFab  plotMF(grids,dmap,n_data_items,nGrow);
+    std::unique_ptr<MultiFab> plotMF(new MultiFab(grids,dmap,n_data_items,nGrow));
     MultiFab* this_dat = 0;
     //
     // Cull data from state variables -- use no ghost cells.
@@ -1127,7 +1153,7 @@ Castro::plotFileOutput(const std::string& dir,
 	int typ  = plot_var_map[i].first;
 	int comp = plot_var_map[i].second;
 	this_dat = &state[typ].newData();
-	MultiFab::Copy(plotMF,*this_dat,comp,cnt,1,nGrow);
+	MultiFab::Copy(*plotMF,*this_dat,comp,cnt,1,nGrow);
 	cnt++;
     }
     //
@@ -1135,18 +1161,20 @@ Castro::plotFileOutput(const std::string& dir,
     //
     if (derive_names.size() > 0)
     {
+	derive_batch(derive_names,cur_time,nGrow);
+
 	for (std::list<std::string>::iterator it = derive_names.begin();
 	     it != derive_names.end(); ++it)
 	{
 	    auto derive_dat = derive(*it,cur_time,nGrow);
-	    MultiFab::Copy(plotMF,*derive_dat,0,cnt,1,nGrow);
+	    MultiFab::Copy(*plotMF,*derive_dat,0,cnt,1,nGrow);
 	    cnt++;
 	}
     }
 
 #ifdef RADIATION
     if (Radiation::nplotvar > 0) {
-	MultiFab::Copy(plotMF,*(radiation->plotvar[level]),0,cnt,Radiation::nplotvar,0);
+	MultiFab::Copy(*plotMF,*(radiation->plotvar[level]),0,cnt,Radiation::nplotvar,0);
 	cnt += Radiation::nplotvar;
     }
 #endif
@@ -1156,5 +1184,11 @@ Castro::plotFileOutput(const std::string& dir,
     //
     std::string TheFullPath = FullPath;
     TheFullPath += BaseName;
-    VisMF::Write(plotMF,TheFullPath,how,true);
+
+    if (async_plotfiles) {
+        // plotMF is handed to the background writer, which owns it now
+        AsyncWriter::write(std::move(plotMF),TheFullPath);
+    } else {
+        VisMF::Write(*plotMF,TheFullPath,how,true);
+    }
 }
@@ -0,0 +1,166 @@
+#include "Castro_kernel_stats.H"
+
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Utility.H>
+
+#include <iomanip>
+
+using namespace amrex;
+
+bool KernelStats::active = false;
+KernelStats::Timer* KernelStats::current = nullptr;
+std::ofstream KernelStats::log;
+Vector<std::array<KernelStats::Counters, KernelStats::num_kernels> > KernelStats::counters;
+
+const char*
+KernelStats::name (int kernel)
+{
+    static const char* names[num_kernels] = { "ctoprim", "hydro", "mol_hydro", "burn",
+                                              "gravity", "fillpatch", "reflux", "tagging" };
+    return names[kernel];
+}
+
+void
+KernelStats::initialize (const std::string& filename)
+{
+    active = true;
+
+    if (ParallelDescriptor::IOProcessor()) {
+
+        // Append, so a restarted run continues the log, and only write
+        // the header for a new file.
+
+        const bool exists = std::ifstream(filename).good();
+
+        log.open(filename, std::ios::out | std::ios::app);
+
+        if (!log.good())
+            amrex::FileOpenFailed(filename);
+
+        if (!exists)
+            log << "step,time,level,kernel,calls,zones,bytes,max_seconds,mean_seconds,zones_per_second" << std::endl;
+
+    }
+}
+
+void
+KernelStats::finalize ()
+{
+    if (log.is_open())
+        log.close();
+
+    counters.clear();
+    active = false;
+}
+
+void
+KernelStats::add (int kernel, int level, Real seconds, long zones, long bytes)
+{
+    if (!active) return;
+
+    if (level >= counters.size())
+        counters.resize(level + 1);
+
+    Counters& c = counters[level][kernel];
+
+    c.calls   += 1;
+    c.zones   += zones;
+    c.bytes   += bytes;
+    c.seconds += seconds;
+}
+
+void
+KernelStats::writeStep (int step, Real time)
+{
+    if (!active) return;
+
+    // Every rank calls the same kernels, so the number of levels is
+    // the same everywhere.
+
+    const int nlevs = counters.size();
+
+    Vector<Real> tmax(nlevs * num_kernels), tsum(nlevs * num_kernels);
+
+    for (int lev = 0; lev < nlevs; ++lev)
+        for (int k = 0; k < num_kernels; ++k)
+            tmax[lev * num_kernels + k] = tsum[lev * num_kernels + k] = counters[lev][k].seconds;
+
+    const int IOProc = ParallelDescriptor::IOProcessorNumber();
+
+    ParallelDescriptor::ReduceRealMax(tmax.dataPtr(), tmax.size(), IOProc);
+    ParallelDescriptor::ReduceRealSum(tsum.dataPtr(), tsum.size(), IOProc);
+
+    if (ParallelDescriptor::IOProcessor()) {
+
+        const Real nprocs = ParallelDescriptor::NProcs();
+
+        for (int lev = 0; lev < nlevs; ++lev) {
+            for (int k = 0; k < num_kernels; ++k) {
+
+                const Counters& c = counters[lev][k];
+
+                if (c.calls == 0) continue;
+
+                const Real t = tmax[lev * num_kernels + k];
+
+                log << step << "," << std::setprecision(12) << time << ","
+                    << lev << "," << name(k) << ","
+                    << c.calls << "," << c.zones << "," << c.bytes << ","
+                    << std::setprecision(6) << t << "," << tsum[lev * num_kernels + k] / nprocs << ","
+                    << (t > 0.0 ? c.zones / t : 0.0) << "\n";
+
+            }
+        }
+
+        log.flush();
+
+    }
+
+    for (auto& lev_counters : counters)
+        for (auto& c : lev_counters)
+            c = Counters();
+}
+
+KernelStats::Timer::Timer (int kernel_, int level_, const BoxArray& ba, int ncomp)
+    : kernel(kernel_), level(level_), zones(0), bytes(0), strt(0.0), inner(0.0), outer(nullptr)
+{
+    if (!active) return;
+
+    zones = ba.numPts();
+    bytes = zones * ncomp * sizeof(Real);
+
+    start();
+}
+
+KernelStats::Timer::Timer (int kernel_, int level_, long zones_, int ncomp)
+    : kernel(kernel_), level(level_), zones(zones_), bytes(zones_ * ncomp * sizeof(Real)),
+      strt(0.0), inner(0.0), outer(nullptr)
+{
+    if (!active) return;
+
+    start();
+}
+
+void
+KernelStats::Timer::start ()
+{
+    outer = current;
+    current = this;
+
+    strt = ParallelDescriptor::second();
+}
+
+KernelStats::Timer::~Timer ()
+{
+    if (!active) return;
+
+    const Real elapsed = ParallelDescriptor::second() - strt;
+
+    add(kernel, level, elapsed - inner, zones, bytes);
+
+    // The whole of this call is inner time for the timer we are in.
+
+    current = outer;
+    if (outer)
+        outer->inner += elapsed;
+}
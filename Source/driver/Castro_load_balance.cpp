@@ -0,0 +1,149 @@
+#include "Castro.H"
+
+#ifdef SELF_GRAVITY
+#include "Gravity.H"
+#endif
+
+#include <AMReX_DistributionMapping.H>
+
+#include <algorithm>
+
+using namespace amrex;
+
+namespace {
+
+    //
+    // The load on the busiest task divided by the mean load.
+    //
+    Real imbalance (const Vector<Real>& box_cost, const DistributionMapping& dm)
+    {
+        Vector<Real> rank_cost(ParallelDescriptor::NProcs(), 0.0);
+
+        Real total = 0.0;
+        for (int i = 0; i < box_cost.size(); ++i) {
+            rank_cost[dm[i]] += box_cost[i];
+            total += box_cost[i];
+        }
+
+        if (total <= 0.0) return 1.0;
+
+        const Real max_cost = *std::max_element(rank_cost.begin(), rank_cost.end());
+
+        return max_cost * rank_cost.size() / total;
+    }
+
+}
+
+void
+Castro::load_balance (Amr* amr)
+{
+    BL_PROFILE("Castro::load_balance()");
+
+    if (ParallelDescriptor::NProcs() == 1) return;
+
+    const Real strt = ParallelDescriptor::second();
+
+    for (int lev = 0; lev <= amr->finestLevel(); ++lev) {
+
+        Castro& castro = dynamic_cast<Castro&>(amr->getLevel(lev));
+
+        MultiFab& cost = castro.lb_cost;
+
+        // The measured cost of each grid, known to every task.
+
+        Vector<Real> box_cost(cost.size(), 0.0);
+
+        for (MFIter mfi(cost); mfi.isValid(); ++mfi)
+            box_cost[mfi.index()] = cost[mfi].sum(mfi.validbox(), 0);
+
+        ParallelDescriptor::ReduceRealSum(box_cost.dataPtr(), box_cost.size());
+
+        const Real old_imbalance = imbalance(box_cost, cost.DistributionMap());
+
+        if (old_imbalance <= 1.0 + load_balance_threshold) {
+
+            if (verbose)
+                amrex::Print() << "Castro::load_balance() level " << lev
+                               << ": " << box_cost.size() << " grids, imbalance (max/mean) = "
+                               << old_imbalance << std::endl;
+
+            cost.setVal(0.0);
+            continue;
+
+        }
+
+        const DistributionMapping new_dm = DistributionMapping::makeKnapSack(cost);
+
+        const Real new_imbalance = imbalance(box_cost, new_dm);
+
+        if (verbose)
+            amrex::Print() << "Castro::load_balance() level " << lev
+                           << ": " << box_cost.size() << " grids, imbalance (max/mean) = "
+                           << old_imbalance << ", " << new_imbalance
+                           << " with the new distribution" << std::endl;
+
+        // Moving the data isn't free, so only do it if it helps.
+
+        if (new_imbalance >= old_imbalance) {
+            cost.setVal(0.0);
+            continue;
+        }
+
+#ifdef SELF_GRAVITY
+        // The new level gets fresh grad_phi from Gravity::install_level,
+        // so hang on to the old ones to copy from.
+
+        Vector<std::unique_ptr<MultiFab> > grad_phi_prev, grad_phi_curr;
+
+        if (do_grav && gravity->get_gravity_type() == "PoissonGrav") {
+            std::swap(grad_phi_prev, gravity->get_grad_phi_prev(lev));
+            std::swap(grad_phi_curr, gravity->get_grad_phi_curr(lev));
+        }
+#endif
+
+        // This builds a new level object on new_dm and fills it from the
+        // old one (see Castro::init(AmrLevel&)), which is then deleted,
+        // so castro and cost must not be used after this.
+
+        amr->InstallNewDistributionMap(lev, new_dm);
+
+        // The mask of the level above is built on this level's
+        // distribution, so it has to be rebuilt.
+
+        if (lev < amr->finestLevel())
+            dynamic_cast<Castro&>(amr->getLevel(lev+1)).fine_mask.clear();
+
+#ifdef SELF_GRAVITY
+        for (int n = 0; n < grad_phi_prev.size(); ++n) {
+            MultiFab& mf = *gravity->get_grad_phi_prev(lev)[n];
+            mf.copy(*grad_phi_prev[n], 0, 0, mf.nComp(), mf.nGrow(), mf.nGrow());
+        }
+
+        for (int n = 0; n < grad_phi_curr.size(); ++n) {
+            MultiFab& mf = *gravity->get_grad_phi_curr(lev)[n];
+            mf.copy(*grad_phi_curr[n], 0, 0, mf.nComp(), mf.nGrow(), mf.nGrow());
+        }
+#endif
+
+#ifdef AMREX_PARTICLES
+        if (TracerPC)
+            TracerPC->Redistribute(lev);
+#endif
+
+    }
+
+    if (verbose > 1)
+    {
+        const int IOProc = ParallelDescriptor::IOProcessorNumber();
+        Real      end    = ParallelDescriptor::second() - strt;
+
+#ifdef BL_LAZY
+        Lazy::QueueReduction( [=] () mutable {
+#endif
+        ParallelDescriptor::ReduceRealMax(end,IOProc);
+        amrex::Print() << "Castro::load_balance() time = " << end << std::endl;
+#ifdef BL_LAZY
+        });
+#endif
+    }
+}
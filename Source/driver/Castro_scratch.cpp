@@ -0,0 +1,105 @@
+#include "Castro_scratch.H"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace amrex;
+
+Vector<Vector<std::unique_ptr<FArrayBox> > > ScratchArena::fabs;
+Vector<Vector<long> > ScratchArena::capacity;
+Vector<long> ScratchArena::num_allocs;
+
+void
+ScratchArena::initialize ()
+{
+#ifdef _OPENMP
+    const int nthreads = omp_get_max_threads();
+#else
+    const int nthreads = 1;
+#endif
+
+    fabs.resize(nthreads);
+    capacity.resize(nthreads);
+    num_allocs.resize(nthreads, 0);
+
+    for (int t = 0; t < nthreads; ++t) {
+        fabs[t].resize(num_slots);
+        capacity[t].resize(num_slots, 0);
+        for (int n = 0; n < num_slots; ++n)
+            fabs[t][n].reset(new FArrayBox());
+    }
+}
+
+void
+ScratchArena::finalize ()
+{
+    fabs.clear();
+    capacity.clear();
+    num_allocs.clear();
+}
+
+FArrayBox&
+ScratchArena::fab (int slot, const Box& bx, int ncomp)
+{
+    if (slot < 0 || slot >= num_slots)
+        amrex::Abort("ScratchArena::fab: invalid slot");
+
+#ifdef _OPENMP
+    // Threads of different teams in a nested parallel region have the
+    // same thread numbers, so they would share FABs.
+    if (omp_get_active_level() > 1)
+        amrex::Abort("ScratchArena::fab: can't be used in a nested parallel region");
+
+    const int tid = omp_get_thread_num();
+#else
+    const int tid = 0;
+#endif
+
+    // The tables are sized when the arena is initialized, so running
+    // with more threads than there were then isn't supported.
+    if (tid >= static_cast<int>(fabs.size()))
+        amrex::Abort("ScratchArena::fab: more threads than when the arena was initialized");
+
+    // FArrayBox::resize only reallocates when the new size is larger
+    // than what it already holds, so we mirror that here to know
+    // when we actually went to the heap.
+
+    const long npts = bx.numPts() * ncomp;
+
+    if (npts > capacity[tid][slot]) {
+        capacity[tid][slot] = npts;
+        num_allocs[tid] += 1;
+    }
+
+    FArrayBox& f = *fabs[tid][slot];
+    f.resize(bx, ncomp);
+
+    return f;
+}
+
+long
+ScratchArena::numAllocations ()
+{
+    long n = 0;
+    for (long c : num_allocs)
+        n += c;
+    return n;
+}
+
+void
+ScratchArena::resetCounters ()
+{
+    for (long& c : num_allocs)
+        c = 0;
+}
+
+long
+ScratchArena::bytesReserved ()
+{
+    long n = 0;
+    for (const auto& t : capacity)
+        for (long c : t)
+            n += c;
+    return n * sizeof(Real);
+}
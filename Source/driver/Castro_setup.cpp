@@ -6,6 +6,10 @@
 #include "Castro_F.H"
 #include <Derive_F.H>
 #include "Derive.H"
+#include "Castro_scratch.H"
+#include "Castro_async_io.H"
+#include "Castro_kernel_stats.H"
+#include "Castro_tile_tuner.H"
 #ifdef RADIATION
 # include "Radiation.H"
 # include "RAD_F.H"
@@ -170,6 +174,22 @@ Castro::variableSetUp ()
   // Initialize the amr info
   amrinfo_init();
 
+  // Set up the per-thread scratch space for the tile temporaries
+  ScratchArena::initialize();
+
+  // Start the background plotfile writer
+  if (async_plotfiles)
+    AsyncWriter::initialize(static_cast<long>(async_plotfile_max_mb * 1024.0 * 1024.0));
+
+  // Open the per-step kernel statistics log
+  if (kernel_stats)
+    KernelStats::initialize(kernel_stats_file);
+
+  // Set up the tile size autotuner; on restart, the sizes it picked are
+  // read back from the checkpoint in Castro::restart
+  if (hydro_tile_autotune)
+    TileTuner::initialize(hydro_tile_size, ctoprim_tile_size, hydro_tile_autotune_calls);
+
 
   const int dm = BL_SPACEDIM;
 
@@ -655,15 +675,6 @@ Castro::variableSetUp ()
   }
 #endif
 
-  if (use_custom_knapsack_weights) {
-      Knapsack_Weight_Type = desc_lst.size();
-      desc_lst.addDescriptor(Knapsack_Weight_Type, IndexType::TheCellType(), StateDescriptor::Point,
-			     0, 1, &pc_interp);
-      // Because we use piecewise constant interpolation, we do not use bc and BndryFunc.
-      desc_lst.setComponent(Knapsack_Weight_Type, 0, "KnapsackWeight",
-			    bc, BndryFunc(ca_nullfill));
-  }
-
   num_state_type = desc_lst.size();
 
   //
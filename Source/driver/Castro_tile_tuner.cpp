@@ -0,0 +1,204 @@
+#include "Castro_tile_tuner.H"
+
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Print.H>
+#include <AMReX_Utility.H>
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+
+using namespace amrex;
+
+bool TileTuner::active = false;
+int TileTuner::calls_per_candidate = 1;
+
+bool TileTuner::done[TileTuner::num_kernels] = { true, true };
+int TileTuner::calls[TileTuner::num_kernels] = { 0, 0 };
+Vector<IntVect> TileTuner::candidates[TileTuner::num_kernels];
+Vector<Real> TileTuner::best_time[TileTuner::num_kernels];
+
+namespace {
+
+    const char* kernel_name[TileTuner::num_kernels] = { "hydro", "ctoprim" };
+
+    // A long, unit stride first dimension with a few different cross
+    // sections, and a couple of more cubic tiles.
+
+#if BL_SPACEDIM == 1
+    const Vector<IntVect> default_candidates = { IntVect(1024), IntVect(256), IntVect(64) };
+#elif BL_SPACEDIM == 2
+    const Vector<IntVect> default_candidates = { IntVect(1024,16), IntVect(1024,8), IntVect(1024,32),
+                                                 IntVect(128,16), IntVect(64,64) };
+#else
+    const Vector<IntVect> default_candidates = { IntVect(1024,16,16), IntVect(1024,8,8), IntVect(1024,32,32),
+                                                 IntVect(64,16,16), IntVect(32,32,32) };
+#endif
+
+}
+
+void
+TileTuner::initialize (const IntVect& hydro_tile_size,
+                       const IntVect& ctoprim_tile_size,
+                       int calls_per_candidate_in)
+{
+    active = true;
+    calls_per_candidate = std::max(calls_per_candidate_in, 1);
+
+    const IntVect start[num_kernels] = { hydro_tile_size, ctoprim_tile_size };
+
+    for (int k = 0; k < num_kernels; ++k) {
+
+        // The tile size from the inputs goes first, so it is the one
+        // used for the first calls.
+
+        candidates[k].clear();
+        candidates[k].push_back(start[k]);
+
+        for (const auto& c : default_candidates)
+            if (c != start[k])
+                candidates[k].push_back(c);
+
+        best_time[k].assign(candidates[k].size(), std::numeric_limits<Real>::max());
+
+        calls[k] = 0;
+        done[k] = false;
+
+    }
+}
+
+void
+TileTuner::finish (int kernel, IntVect& tile_size)
+{
+    Vector<Real>& t = best_time[kernel];
+
+    // Every rank makes the same number of calls, so this is matched.
+
+    ParallelDescriptor::ReduceRealMax(t.dataPtr(), t.size());
+
+    int best = 0;
+    for (int i = 1; i < t.size(); ++i)
+        if (t[i] < t[best])
+            best = i;
+
+    tile_size = candidates[kernel][best];
+    done[kernel] = true;
+
+    amrex::Print() << "... tile size autotune: " << kernel_name[kernel] << " uses "
+                   << tile_size << " (" << t[best] << " s per zone; "
+                   << candidates[kernel][0] << " took " << t[0] << ")" << std::endl;
+}
+
+TileTuner::Timer::Timer (int kernel_, int level, IntVect& tile_size_, long zones_)
+    : kernel(kernel_), tile_size(tile_size_), zones(zones_), strt(0.0), elapsed(0.0), timing(false)
+{
+    if (!tuning(kernel) || level != 0 || zones <= 0) return;
+
+    timing = true;
+    tile_size = candidates[kernel][calls[kernel] / (calls_per_candidate + 1)];
+
+    ParallelDescriptor::Barrier();
+    strt = ParallelDescriptor::second();
+}
+
+TileTuner::Timer::~Timer ()
+{
+    if (!timing) return;
+
+    pause();
+
+    const Real t = elapsed / zones;
+
+    // The first call of each candidate is a warm-up, and isn't counted.
+
+    const int i = calls[kernel] / (calls_per_candidate + 1);
+
+    // Keep the fastest call, which is the least affected by noise.
+
+    if (calls[kernel] % (calls_per_candidate + 1) != 0)
+        best_time[kernel][i] = std::min(best_time[kernel][i], t);
+
+    calls[kernel] += 1;
+
+    if (calls[kernel] == static_cast<int>(candidates[kernel].size()) * (calls_per_candidate + 1))
+        finish(kernel, tile_size);
+}
+
+void
+TileTuner::Timer::pause ()
+{
+    if (!timing) return;
+
+    elapsed += ParallelDescriptor::second() - strt;
+}
+
+void
+TileTuner::Timer::resume ()
+{
+    if (!timing) return;
+
+    strt = ParallelDescriptor::second();
+}
+
+void
+TileTuner::write (const std::string& dir,
+                  const IntVect& hydro_tile_size,
+                  const IntVect& ctoprim_tile_size)
+{
+    if (!ParallelDescriptor::IOProcessor()) return;
+
+    std::ofstream TileSizesFile;
+    const std::string FullPathTileSizesFile = dir + "/TileSizes";
+    TileSizesFile.open(FullPathTileSizesFile.c_str(), std::ios::out);
+
+    if (!TileSizesFile.good())
+        amrex::FileOpenFailed(FullPathTileSizesFile);
+
+    // A kernel that is still being tuned is written as not done, so
+    // a restart picks up the tuning from the start for it.
+
+    TileSizesFile << BL_SPACEDIM << "\n";
+    TileSizesFile << done[hydro] << " " << hydro_tile_size << "\n";
+    TileSizesFile << done[ctoprim] << " " << ctoprim_tile_size << "\n";
+
+    TileSizesFile.close();
+}
+
+bool
+TileTuner::read (const std::string& dir,
+                 IntVect& hydro_tile_size,
+                 IntVect& ctoprim_tile_size)
+{
+    // Read on every rank, as the Diagnostics file is; a checkpoint
+    // from a run without the autotuner doesn't have this file.
+
+    std::ifstream TileSizesFile;
+    const std::string FullPathTileSizesFile = dir + "/TileSizes";
+    TileSizesFile.open(FullPathTileSizesFile.c_str(), std::ios::in);
+
+    if (!TileSizesFile.good())
+        return false;
+
+    int dim = 0;
+    int tuned[num_kernels] = { 0, 0 };
+    IntVect tile_size[num_kernels];
+
+    TileSizesFile >> dim;
+    for (int k = 0; k < num_kernels; ++k)
+        TileSizesFile >> tuned[k] >> tile_size[k];
+
+    if (!TileSizesFile.good() || dim != BL_SPACEDIM)
+        return false;
+
+    if (tuned[hydro]) {
+        hydro_tile_size = tile_size[hydro];
+        done[hydro] = true;
+    }
+
+    if (tuned[ctoprim]) {
+        ctoprim_tile_size = tile_size[ctoprim];
+        done[ctoprim] = true;
+    }
+
+    return tuned[hydro] || tuned[ctoprim];
+}
@@ -28,6 +28,10 @@
 #include "Castro.H"
 #include "Castro_io.H"
 
+#ifdef SELF_GRAVITY
+#include "Gravity.H"
+#endif
+
 using namespace amrex;
 
 std::string inputs_name = "";
@@ -216,6 +220,17 @@ main (int   argc,
     ParallelDescriptor::ReduceRealMax(runtime_total,IOProc);
     ParallelDescriptor::ReduceRealMax(runtime_timestep,IOProc);
 
+    // The retry snapshot is kept per task: report the largest task's
+    // copy time and high-water mark, and the sum of the high-water marks.
+
+    Real retry_snapshot_time = Castro::retry_snapshot_time;
+    long retry_snapshot_bytes_max = Castro::retry_snapshot_bytes_max;
+    long retry_snapshot_bytes_sum = Castro::retry_snapshot_bytes_max;
+
+    ParallelDescriptor::ReduceRealMax(retry_snapshot_time,IOProc);
+    ParallelDescriptor::ReduceLongMax(retry_snapshot_bytes_max,IOProc);
+    ParallelDescriptor::ReduceLongSum(retry_snapshot_bytes_sum,IOProc);
+
     if (ParallelDescriptor::IOProcessor())
     {
         std::cout << "Run time = " << runtime_total << std::endl;
@@ -230,6 +245,45 @@ main (int   argc,
 	std::cout << "\n";
 	std::cout << "  Average number of zones advanced per microsecond: " << std::fixed << std::setprecision(3) << fom << "\n";
 	std::cout << "\n";
+
+#if defined(REACTIONS) && !defined(SDC)
+	if (Castro::num_burn_recoveries > 0.0 || Castro::num_burn_retries > 0) {
+	    std::cout << "  Zones with a failed burn recovered by substepping: " << (long) Castro::num_burn_recoveries << "\n";
+	    std::cout << "  Level advances retried because of a failed burn: " << Castro::num_burn_retries << "\n";
+	    std::cout << "\n";
+	}
+#endif
+
+#ifdef SELF_GRAVITY
+	if (Gravity::num_incremental_solves > 0) {
+	    std::cout << "  Gravity level solves, full / incremental: " << Gravity::num_full_solves
+		      << " / " << Gravity::num_incremental_solves << "\n";
+	    std::cout << "  MLMG iterations saved by the incremental solves: " << Gravity::mlmg_iters_saved << "\n";
+	    std::cout << "\n";
+	}
+#endif
+
+	if (Castro::comm_time_hidden > 0.0 || Castro::comm_time_exposed > 0.0) {
+	    std::cout << "  Sborder ghost zone exchange time overlapped / waited: " << Castro::comm_time_hidden
+		      << " / " << Castro::comm_time_exposed << "\n";
+	    std::cout << "\n";
+	}
+
+	if (retry_snapshot_time > 0.0) {
+	    std::cout << "  Retry snapshot copy time (max over tasks): " << retry_snapshot_time << "\n";
+	    std::cout << "  Retry snapshot high-water mark (MB), max over tasks / summed over tasks: "
+		      << retry_snapshot_bytes_max / (1024.0 * 1024.0) << " / "
+		      << retry_snapshot_bytes_sum / (1024.0 * 1024.0) << "\n";
+	    std::cout << "\n";
+	}
+
+	if (Castro::derive_cache_hits + Castro::derive_cache_misses > 0) {
+	    const long lookups = Castro::derive_cache_hits + Castro::derive_cache_misses;
+	    std::cout << "  Derived fields from the cache / computed: " << Castro::derive_cache_hits
+		      << " / " << Castro::derive_cache_misses
+		      << " (hit rate " << 100.0 * Castro::derive_cache_hits / lookups << "%)\n";
+	    std::cout << "\n";
+	}
     }
 
     if (CArena* arena = dynamic_cast<CArena*>(amrex::The_Arena()))
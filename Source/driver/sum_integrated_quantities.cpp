@@ -2,6 +2,7 @@
 
 #include <Castro.H>
 #include <Castro_F.H>
+#include <Castro_sums.H>
 
 #ifdef SELF_GRAVITY
 #include <Gravity.H>
@@ -15,8 +16,6 @@ Castro::sum_integrated_quantities ()
 
     if (verbose <= 0) return;
 
-    bool local_flag = true;
-
     int finest_level = parent->finestLevel();
     Real time        = state[State_Type].curTime();
     Real mass        = 0.0;
@@ -38,97 +37,81 @@ Castro::sum_integrated_quantities ()
     int datwidth     = 14;
     int datprecision = 6;
 
-    for (int lev = 0; lev <= finest_level; lev++)
-    {
-        Castro& ca_lev = getLevel(lev);
+    // Everything we want, computed in one sweep over each level.
+
+    IntegralSums isum;
 
-        mass   += ca_lev.volWgtSum("density", time, local_flag);
-        mom[0] += ca_lev.volWgtSum("xmom", time, local_flag);
-	mom[1] += ca_lev.volWgtSum("ymom", time, local_flag);
-	mom[2] += ca_lev.volWgtSum("zmom", time, local_flag);
+    const int imass = isum.addVolume("density");
+    const int imom = isum.addVolume("xmom");
+    isum.addVolume("ymom");
+    isum.addVolume("zmom");
 
-	ang_mom[0] += ca_lev.volWgtSum("angular_momentum_x", time, local_flag);
-	ang_mom[1] += ca_lev.volWgtSum("angular_momentum_y", time, local_flag);
-	ang_mom[2] += ca_lev.volWgtSum("angular_momentum_z", time, local_flag);
+    const int iang_mom = isum.addVolume("angular_momentum_x");
+    isum.addVolume("angular_momentum_y");
+    isum.addVolume("angular_momentum_z");
 
 #ifdef HYBRID_MOMENTUM
-	hyb_mom[0] += ca_lev.volWgtSum("rmom", time, local_flag);
-	hyb_mom[1] += ca_lev.volWgtSum("lmom", time, local_flag);
-	hyb_mom[2] += ca_lev.volWgtSum("zmom", time, local_flag);
+    const int ihyb_mom = isum.addVolume("rmom");
+    isum.addVolume("lmom");
+    isum.addVolume("zmom");
 #endif
 
-	if (show_center_of_mass) {
-	   com[0] += ca_lev.locWgtSum("density", time, 0, local_flag);
-	   com[1] += ca_lev.locWgtSum("density", time, 1, local_flag);
-	   com[2] += ca_lev.locWgtSum("density", time, 2, local_flag);
-	}
+    int icom = -1;
+    if (show_center_of_mass) {
+        icom = isum.addLocation("density", 0);
+        isum.addLocation("density", 1);
+        isum.addLocation("density", 2);
+    }
+
+    const int irho_e = isum.addVolume("rho_e");
+    const int irho_K = isum.addVolume("kineng");
+    const int irho_E = isum.addVolume("rho_E");
 
-       rho_e += ca_lev.volWgtSum("rho_e", time, local_flag);
-       rho_K += ca_lev.volWgtSum("kineng", time, local_flag);
-       rho_E += ca_lev.volWgtSum("rho_E", time, local_flag);
 #ifdef SELF_GRAVITY
-        if (gravity->get_gravity_type() == "PoissonGrav")
-               rho_phi += ca_lev.volProductSum("density", "phiGrav", time, local_flag);
+    int irho_phi = -1;
+    if (gravity->get_gravity_type() == "PoissonGrav")
+        irho_phi = isum.addProduct("density", "phiGrav");
 #endif
 
+    Real strt_time = ParallelDescriptor::second();
+
+    for (int lev = 0; lev <= finest_level; lev++)
+        getLevel(lev).integrate(isum, time);
+
+    if (verbose > 1) {
+        Real run_time = ParallelDescriptor::second() - strt_time;
+        ParallelDescriptor::ReduceRealMax(run_time, ParallelDescriptor::IOProcessorNumber());
+        amrex::Print() << "Castro::sum_integrated_quantities() integrals computed in " << run_time << " seconds" << std::endl;
     }
 
     if (verbose > 0)
     {
 
-#ifdef HYBRID_MOMENTUM
-#ifdef SELF_GRAVITY
-       const int nfoo = 14;
-#else
-       const int nfoo = 13;
-#endif
-#else
-#ifdef SELF_GRAVITY
-       const int nfoo = 11;
-#else
-       const int nfoo = 10;
-#endif
-#endif
-
-	Real foo[nfoo] = {mass, mom[0], mom[1], mom[2], ang_mom[0], ang_mom[1], ang_mom[2],
-#ifdef HYBRID_MOMENTUM
-			  hyb_mom[0], hyb_mom[1], hyb_mom[2],
-#endif
-#ifdef SELF_GRAVITY
-			  rho_e, rho_K, rho_E, rho_phi};
-#else
-			  rho_e, rho_K, rho_E};
-#endif
-
 #ifdef BL_LAZY
         Lazy::QueueReduction( [=] () mutable {
 #endif
 
-	ParallelDescriptor::ReduceRealSum(foo, nfoo, ParallelDescriptor::IOProcessorNumber());
-
-	if (show_center_of_mass)
-	    ParallelDescriptor::ReduceRealSum(com, 3, ParallelDescriptor::IOProcessorNumber());
+	isum.reduce(ParallelDescriptor::IOProcessorNumber());
 
 	if (ParallelDescriptor::IOProcessor()) {
 
-	    int i = 0;
-	    mass       = foo[i++];
-	    mom[0]     = foo[i++];
-            mom[1]     = foo[i++];
-            mom[2]     = foo[i++];
-	    ang_mom[0] = foo[i++];
-	    ang_mom[1] = foo[i++];
-	    ang_mom[2] = foo[i++];
+	    mass = isum[imass];
+	    for (int i = 0; i < 3; i++) {
+		mom[i]     = isum[imom + i];
+		ang_mom[i] = isum[iang_mom + i];
 #ifdef HYBRID_MOMENTUM
-	    hyb_mom[0] = foo[i++];
-	    hyb_mom[1] = foo[i++];
-	    hyb_mom[2] = foo[i++];
+		hyb_mom[i] = isum[ihyb_mom + i];
 #endif
-	    rho_e      = foo[i++];
-	    rho_K      = foo[i++];
-            rho_E      = foo[i++];
+		if (show_center_of_mass)
+		    com[i] = isum[icom + i];
+	    }
+
+	    rho_e      = isum[irho_e];
+	    rho_K      = isum[irho_K];
+	    rho_E      = isum[irho_E];
 #ifdef SELF_GRAVITY
-	    rho_phi    = foo[i++];
+	    if (irho_phi >= 0)
+		rho_phi = isum[irho_phi];
 
 	    // Total energy is -1/2 * rho * phi + rho * E for self-gravity,
 	    // and -rho * phi + rho * E for externally-supplied gravity.
@@ -2,6 +2,7 @@
 
 #include <Castro.H>
 #include <Castro_F.H>
+#include <Castro_sums.H>
 
 #ifdef SELF_GRAVITY
 #include <Gravity.H>
@@ -10,6 +11,269 @@
 
 using namespace amrex;
 
+int
+IntegralSums::addField (const std::string& name)
+{
+    for (int f = 0; f < fields.size(); ++f)
+        if (fields[f] == name) return f;
+    fields.push_back(name);
+    return fields.size() - 1;
+}
+
+int
+IntegralSums::add (int k, int f1, int f2, int dir)
+{
+    kind.push_back(k);
+    field1.push_back(f1);
+    field2.push_back(f2);
+    idir.push_back(dir);
+    sums.push_back(0.0);
+    return kind.size() - 1;
+}
+
+int
+IntegralSums::addVolume (const std::string& name)
+{
+    return add(Volume, addField(name), -1, -1);
+}
+
+int
+IntegralSums::addLocation (const std::string& name, int dir)
+{
+    return add(Location, addField(name), -1, dir);
+}
+
+int
+IntegralSums::addProduct (const std::string& name1, const std::string& name2)
+{
+    const int f1 = addField(name1);
+    const int f2 = addField(name2);
+    return add(Product, f1, f2, -1);
+}
+
+void
+IntegralSums::reset ()
+{
+    for (auto& x : sums) x = 0.0;
+}
+
+void
+IntegralSums::reduce (int proc)
+{
+    if (sums.size() == 0) return;
+
+    if (proc < 0)
+        ParallelDescriptor::ReduceRealSum(sums.dataPtr(), sums.size());
+    else
+        ParallelDescriptor::ReduceRealSum(sums.dataPtr(), sums.size(), proc);
+}
+
+void
+Castro::integrate (IntegralSums& isum, Real time)
+{
+    BL_PROFILE("Castro::integrate()");
+
+    const int nfld = isum.numFields();
+    const int nint = isum.size();
+
+    if (nint == 0) return;
+
+    const Real* dx = geom.CellSize();
+    const Real dt = parent->dtLevel(level);
+    const int* dom_lo = geom.Domain().loVect();
+    const int* dom_hi = geom.Domain().hiVect();
+
+    // Each field is either read straight from its state, evaluated tile
+    // by tile with its derive function, or -- for anything the tile
+    // evaluation can't do (derives that need ghost cells or data at
+    // another time, particle counts, ...) -- derived for the whole level
+    // up front as volWgtSum would.
+
+    enum { FromState = 0, FromDerive, FromMultiFab };
+
+    Vector<int> how(nfld, FromMultiFab);
+    Vector<int> st_type(nfld, -1);
+    Vector<int> st_comp(nfld, -1);
+    Vector<const DeriveRec*> recs(nfld, nullptr);
+    Vector<std::unique_ptr<MultiFab> > whole(nfld);
+
+    const Box unit_box(IntVect::TheZeroVector(), IntVect::TheUnitVector());
+
+    for (int f = 0; f < nfld; ++f) {
+
+        const std::string& name = isum.fieldName(f);
+
+        int typ, comp;
+
+        if (isStateVariable(name, typ, comp)) {
+
+            if (state[typ].curTime() == time && get_new_data(typ).boxArray() == grids) {
+                how[f] = FromState;
+                st_type[f] = typ;
+                st_comp[f] = comp;
+            }
+
+        } else if (const DeriveRec* rec = derive_lst.get(name)) {
+
+            bool tile_ok = rec->derFunc3D() != nullptr &&
+                           rec->numDerive() == 1 &&
+                           rec->boxMap()(unit_box) == unit_box &&
+                           name != "particle_count" && name != "total_particle_count";
+#ifdef NEUTRINO
+            tile_ok = tile_ok && name.substr(0,4) != "Neut";
+#endif
+
+            for (int k = 0; k < rec->numRange() && tile_ok; ++k) {
+                int st, sc, nc;
+                rec->getRange(k, st, sc, nc);
+                tile_ok = state[st].curTime() == time && get_new_data(st).boxArray() == grids;
+            }
+
+            if (tile_ok) {
+                how[f] = FromDerive;
+                recs[f] = rec;
+            }
+
+        }
+
+        if (how[f] == FromMultiFab) {
+            whole[f] = derive(name, time, 0);
+            BL_ASSERT(whole[f]);
+        }
+
+    }
+
+    const MultiFab* mask = nullptr;
+    if (level < parent->finestLevel())
+        mask = &getLevel(level+1).build_fine_mask();
+
+    const MultiFab& S_new = get_new_data(State_Type);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        Vector<Real> priv(nint, 0.0);
+
+        FArrayBox vol_masked;
+        FArrayBox src;
+        Vector<std::unique_ptr<FArrayBox> > der(nfld);
+        Vector<const FArrayBox*> fab(nfld, nullptr);
+        Vector<int> fcomp(nfld, 0);
+
+        for (MFIter mfi(S_new, true); mfi.isValid(); ++mfi)
+        {
+            const Box& box = mfi.tilebox();
+            const int* lo  = box.loVect();
+            const int* hi  = box.hiVect();
+
+            // The fine mask is applied once, to the volume.
+
+            vol_masked.resize(box, 1);
+            vol_masked.copy(volume[mfi], box, 0, box, 0, 1);
+            if (mask)
+                vol_masked.mult((*mask)[mfi], box, 0, 0, 1);
+
+            // Get every field on this tile.
+
+            for (int f = 0; f < nfld; ++f) {
+
+                if (how[f] == FromState) {
+
+                    fab[f] = &get_new_data(st_type[f])[mfi];
+                    fcomp[f] = st_comp[f];
+
+                } else if (how[f] == FromDerive) {
+
+                    const DeriveRec* rec = recs[f];
+
+                    src.resize(box, rec->numState());
+                    int dc = 0;
+                    for (int k = 0; k < rec->numRange(); ++k) {
+                        int st, sc, nc;
+                        rec->getRange(k, st, sc, nc);
+                        src.copy(get_new_data(st)[mfi], box, sc, box, dc, nc);
+                        dc += nc;
+                    }
+
+                    if (!der[f]) der[f].reset(new FArrayBox());
+                    der[f]->resize(box, 1);
+
+                    int n_der = 1;
+                    int n_state = rec->numState();
+                    int grid_no = mfi.index();
+                    const int* bcr = rec->getBC();
+                    const RealBox gridloc(box, dx, geom.ProbLo());
+
+                    rec->derFunc3D()(der[f]->dataPtr(), AMREX_ARLIM_3D(lo), AMREX_ARLIM_3D(hi), &n_der,
+                                     src.dataPtr(), AMREX_ARLIM_3D(lo), AMREX_ARLIM_3D(hi), &n_state,
+                                     AMREX_ARLIM_3D(lo), AMREX_ARLIM_3D(hi),
+                                     AMREX_ARLIM_3D(dom_lo), AMREX_ARLIM_3D(dom_hi),
+                                     AMREX_ZFILL(dx), AMREX_ZFILL(gridloc.lo()),
+                                     &time, &dt,
+                                     AMREX_BCREC_3D(bcr),
+                                     &level, &grid_no);
+
+                    fab[f] = der[f].get();
+                    fcomp[f] = 0;
+
+                } else {
+
+                    fab[f] = &(*whole[f])[mfi];
+                    fcomp[f] = 0;
+
+                }
+
+            }
+
+            // Now all of the integrals, on data that is in cache.
+
+            for (int n = 0; n < nint; ++n) {
+
+                const FArrayBox& f1 = *fab[isum.field1[n]];
+                const int c1 = fcomp[isum.field1[n]];
+
+                if (isum.kind[n] == IntegralSums::Volume) {
+
+                    ca_summass(ARLIM_3D(lo), ARLIM_3D(hi),
+                               BL_TO_FORTRAN_N_ANYD(f1, c1),
+                               ZFILL(dx), BL_TO_FORTRAN_ANYD(vol_masked),
+                               &priv[n]);
+
+                } else if (isum.kind[n] == IntegralSums::Location) {
+
+                    Real s = 0.0;
+                    ca_sumlocmass(ARLIM_3D(lo), ARLIM_3D(hi),
+                                  BL_TO_FORTRAN_N_ANYD(f1, c1),
+                                  ZFILL(dx), BL_TO_FORTRAN_ANYD(vol_masked),
+                                  &s, isum.idir[n]);
+                    priv[n] += s;
+
+                } else {
+
+                    const FArrayBox& f2 = *fab[isum.field2[n]];
+                    const int c2 = fcomp[isum.field2[n]];
+
+                    ca_sumproduct(ARLIM_3D(lo), ARLIM_3D(hi),
+                                  BL_TO_FORTRAN_N_ANYD(f1, c1),
+                                  BL_TO_FORTRAN_N_ANYD(f2, c2),
+                                  ZFILL(dx), BL_TO_FORTRAN_ANYD(vol_masked),
+                                  &priv[n]);
+
+                }
+
+            }
+
+        }
+
+#ifdef _OPENMP
+#pragma omp critical (castro_integrate)
+#endif
+        for (int n = 0; n < nint; ++n)
+            isum.sums[n] += priv[n];
+    }
+}
+
 Real
 Castro::sumDerive (const std::string& name,
                    Real               time,
@@ -244,6 +244,8 @@ void Castro::construct_old_gravity_source(MultiFab& source, MultiFab& state, Rea
     {
 	const Box& bx = mfi.tilebox();
 
+	const Real cost_start = ParallelDescriptor::second();
+
 	ca_gsrc(ARLIM_3D(bx.loVect()), ARLIM_3D(bx.hiVect()),
 		ARLIM_3D(domlo), ARLIM_3D(domhi),
 		BL_TO_FORTRAN_ANYD(state[mfi]),
@@ -254,6 +256,8 @@ void Castro::construct_old_gravity_source(MultiFab& source, MultiFab& state, Rea
 		BL_TO_FORTRAN_ANYD(source[mfi]),
 		ZFILL(dx),dt,&time);
 
+	add_cost(mfi, ParallelDescriptor::second() - cost_start);
+
     }
 
 }
@@ -283,6 +287,8 @@ void Castro::construct_new_gravity_source(MultiFab& source, MultiFab& state_old,
 	{
 	    const Box& bx = mfi.tilebox();
 
+	    const Real cost_start = ParallelDescriptor::second();
+
 	    ca_corrgsrc(ARLIM_3D(bx.loVect()), ARLIM_3D(bx.hiVect()),
 			ARLIM_3D(domlo), ARLIM_3D(domhi),
 			BL_TO_FORTRAN_ANYD(state_old[mfi]),
@@ -300,6 +306,8 @@ void Castro::construct_new_gravity_source(MultiFab& source, MultiFab& state_old,
 			BL_TO_FORTRAN_ANYD(source[mfi]),
 			ZFILL(dx),dt,&time);
 
+	    add_cost(mfi, ParallelDescriptor::second() - cost_start);
+
 	}
     }
 
@@ -10,8 +10,11 @@
 #include "Castro.H"
 #include <Gravity_F.H>
 #include <Castro_F.H>
+#include "Gravity_tree.H"
+#include "Castro_kernel_stats.H"
 
 #include <AMReX_FillPatchUtil.H>
+#include <AMReX_BoxIterator.H>
 #include <AMReX_MLMG.H>
 #include <AMReX_MLPoisson.H>
 
@@ -28,6 +31,9 @@ int Gravity::test_solves  = 0;
 #endif
 Real Gravity::max_radius_all_in_domain =  0.0;
 Real Gravity::mass_offset    =  0.0;
+long Gravity::num_full_solves = 0;
+long Gravity::num_incremental_solves = 0;
+long Gravity::mlmg_iters_saved = 0;
 
 // ************************************************************************************** //
 
@@ -62,6 +68,15 @@ Gravity::Gravity(Amr* Parent, int _finest_level, BCRec* _phys_bc, int _Density)
     level_solver_resnorm(MAX_LEV),
     volume(MAX_LEV),
     area(MAX_LEV),
+    multipole_basis(MAX_LEV),
+    multipole_basis_center(MAX_LEV),
+    radial_bins(MAX_LEV),
+    radial_bins_center(MAX_LEV),
+    radial_bins_dvol(MAX_LEV, 0.0),
+    radial_bins_vol(MAX_LEV),
+    rho_at_last_solve(MAX_LEV),
+    full_solve_iters(MAX_LEV, 0),
+    last_mlmg_iters(0),
     phys_bc(_phys_bc)
 {
      Density = _Density;
@@ -275,6 +290,12 @@ Gravity::install_level (int                   level,
 
     area[level] = _area;
 
+    multipole_basis[level].reset();
+
+    radial_bins[level].reset();
+
+    rho_at_last_solve[level].reset();
+
     level_solver_resnorm[level] = 0.0;
 
     if (gravity_type == "PoissonGrav") {
@@ -403,6 +424,8 @@ Gravity::solve_for_phi (int               level,
 {
     BL_PROFILE("Gravity::solve_for_phi()");
 
+    KernelStats::Timer stats_timer(KernelStats::gravity, level, grids[level], 2 + BL_SPACEDIM);
+
     if (verbose > 1 && ParallelDescriptor::IOProcessor())
 	std::cout << " ... solve for phi at level " << level << std::endl;
 
@@ -434,12 +457,127 @@ Gravity::solve_for_phi (int               level,
 
         Vector<MultiFab*> res_null;
 
-        level_solver_resnorm[level] = solve_phi_with_mlmg(level, level,
-                                                          phi_p,
-                                                          amrex::GetVecOfPtrs(rhs),
-                                                          grad_phi_p,
-                                                          res_null,
-                                                          time);
+        // With incremental solves, a level whose density has hardly
+        // changed since its last full solve only gets a few V-cycles,
+        // starting from the phi it has now.
+
+        bool incremental = false;
+        int incremental_iters = 0;
+
+        MultiFab rho;
+        std::unique_ptr<MultiFab> phi_check;
+
+        if (incremental_solve) {
+
+            rho.define(grids[level], dmap[level], 1, 0);
+            MultiFab::Copy(rho, *rhs[0], 0, 0, 1, 0);
+
+            const Real drho = density_change(level, rho);
+            incremental = drho >= 0.0 && drho < incremental_drho_tol;
+
+            if (verbose > 1 && ParallelDescriptor::IOProcessor())
+                std::cout << " ... max |drho|/rho since the last full solve = " << drho << std::endl;
+
+            if (incremental && incremental_check) {
+                phi_check.reset(new MultiFab(phi.boxArray(), phi.DistributionMap(), 1, phi.nGrow()));
+                MultiFab::Copy(*phi_check, phi, 0, 0, 1, phi.nGrow());
+            }
+
+        }
+
+        if (incremental) {
+
+            const Real resnorm = solve_phi_with_mlmg(level, level,
+                                                     phi_p,
+                                                     amrex::GetVecOfPtrs(rhs),
+                                                     grad_phi_p,
+                                                     res_null,
+                                                     time, incremental_vcycles);
+
+            incremental_iters = last_mlmg_iters;
+
+            if (resnorm <= incremental_res_ratio * level_solver_resnorm[level]) {
+
+                // level_solver_resnorm keeps the residual of the full
+                // solve, which sets the tolerance of the sync solve.
+
+                num_incremental_solves++;
+                mlmg_iters_saved += std::max(full_solve_iters[level] - incremental_iters, 0);
+
+                if (verbose && ParallelDescriptor::IOProcessor())
+                    std::cout << " ... incremental solve at level " << level << ": "
+                              << incremental_iters << " V-cycles, residual " << resnorm << std::endl;
+
+            } else {
+
+                // Not close enough; carry on to a full solve from here.
+                // The V-cycles we just did were wasted.
+
+                incremental = false;
+                mlmg_iters_saved -= incremental_iters;
+                MultiFab::Copy(*rhs[0], rho, 0, 0, 1, 0);
+
+                if (verbose && ParallelDescriptor::IOProcessor())
+                    std::cout << " ... incremental solve at level " << level << " left residual "
+                              << resnorm << ", doing a full solve" << std::endl;
+
+            }
+
+        }
+
+        if (!incremental) {
+
+            level_solver_resnorm[level] = solve_phi_with_mlmg(level, level,
+                                                              phi_p,
+                                                              amrex::GetVecOfPtrs(rhs),
+                                                              grad_phi_p,
+                                                              res_null,
+                                                              time);
+
+            if (incremental_solve) {
+                rho_at_last_solve[level].reset(new MultiFab(grids[level], dmap[level], 1, 0));
+                MultiFab::Copy(*rho_at_last_solve[level], rho, 0, 0, 1, 0);
+                full_solve_iters[level] = last_mlmg_iters;
+                num_full_solves++;
+            }
+
+        }
+        else if (incremental_check) {
+
+            // Do the full solve from the same starting point, and compare
+            // the potential energy of the two.
+
+            const auto& rhs_check = get_rhs(level, 1, is_new);
+
+            Vector<std::unique_ptr<MultiFab> > grad_phi_check(BL_SPACEDIM);
+            Vector< Vector<MultiFab*> > grad_phi_check_p(1);
+            for (int i = 0; i < BL_SPACEDIM ; i++) {
+                grad_phi_check[i].reset(new MultiFab(grad_phi[i]->boxArray(), grad_phi[i]->DistributionMap(),
+                                                     1, grad_phi[i]->nGrow()));
+                grad_phi_check_p[0].push_back(grad_phi_check[i].get());
+            }
+
+            Vector<MultiFab*> phi_check_p(1, phi_check.get());
+
+            solve_phi_with_mlmg(level, level,
+                                phi_check_p,
+                                amrex::GetVecOfPtrs(rhs_check),
+                                grad_phi_check_p,
+                                res_null,
+                                time);
+
+            MultiFab::Multiply(rho, *volume[level], 0, 0, 1, 0);
+
+            const Real rho_phi_incr = MultiFab::Dot(rho, 0, phi, 0, 1, 0);
+            const Real rho_phi_full = MultiFab::Dot(rho, 0, *phi_check, 0, 1, 0);
+
+            if (ParallelDescriptor::IOProcessor())
+                std::cout << " ... incremental solve at level " << level << ": sum(rho phi dV) = "
+                          << rho_phi_incr << ", full solve " << rho_phi_full << ", relative difference "
+                          << std::abs(rho_phi_incr - rho_phi_full) / std::max(std::abs(rho_phi_full), 1.e-300)
+                          << ", " << last_mlmg_iters << " more iterations" << std::endl;
+
+        }
 
     }
     else {
@@ -465,6 +603,21 @@ Gravity::solve_for_phi (int               level,
     }
 }
 
+Real
+Gravity::density_change (int level, const MultiFab& rho)
+{
+    if (!rho_at_last_solve[level] || rho_at_last_solve[level]->boxArray() != rho.boxArray())
+        return -1.0;
+
+    MultiFab drho(rho.boxArray(), rho.DistributionMap(), 1, 0);
+
+    MultiFab::Copy(drho, rho, 0, 0, 1, 0);
+    MultiFab::Subtract(drho, *rho_at_last_solve[level], 0, 0, 1, 0);
+    MultiFab::Divide(drho, rho, 0, 0, 1, 0);
+
+    return drho.norm0();
+}
+
 void
 Gravity::gravity_sync (int crse_level, int fine_level, const Vector<MultiFab*>& drho, const Vector<MultiFab*>& dphi)
 {
@@ -715,6 +868,13 @@ Gravity::actual_multilevel_solve (int crse_level, int finest_level,
 {
     BL_PROFILE("Gravity::actual_multilevel_solve()");
 
+    long stats_zones = 0;
+    if (KernelStats::enabled())
+        for (int lev = crse_level; lev <= finest_level; ++lev)
+            stats_zones += grids[lev].numPts();
+
+    KernelStats::Timer stats_timer(KernelStats::gravity, crse_level, stats_zones, 2 + BL_SPACEDIM);
+
     for (int ilev = crse_level; ilev <= finest_level ; ++ilev)
         sanity_check(ilev);
 
@@ -1521,6 +1681,15 @@ Gravity::fill_multipole_BCs(int crse_level, int fine_level, const Vector<MultiFa
     const int boundary_only = 1;
 #endif
 
+    // The moments from levels with a cached basis are summed here,
+    // in the layout described in ca_compute_multipole_basis.
+
+    const int nbasis = (lnum + 1) * (lnum + 1);
+
+    Vector<Real> q_cached(nbasis, 0.0);
+
+    bool any_cached = false;
+
     // Use all available data in constructing the boundary conditions,
     // unless the user has indicated that a maximum level at which
     // to stop using the more accurate data.
@@ -1547,6 +1716,56 @@ Gravity::fill_multipole_BCs(int crse_level, int fine_level, const Vector<MultiFa
         const Box& domain = parent->Geom(lev).Domain();
 	const Real* dx = parent->Geom(lev).CellSize();
 
+	if (boundary_only == 1 && get_multipole_basis(lev)) {
+
+	    // The moments are a matrix-vector product of the cached
+	    // basis with the density.  Each thread sums into its own
+	    // slice of priv_q, and the slices are then added up in
+	    // parallel over the moments.
+
+	    const MultiFab& basis = *multipole_basis[lev];
+
+#ifdef _OPENMP
+	    const int nthreads = omp_get_max_threads();
+#else
+	    const int nthreads = 1;
+#endif
+	    Vector<Real> priv_q(nthreads * nbasis, 0.0);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	    {
+#ifdef _OPENMP
+	        Real* q = priv_q.dataPtr() + omp_get_thread_num() * nbasis;
+#else
+	        Real* q = priv_q.dataPtr();
+#endif
+	        for (MFIter mfi(source,true); mfi.isValid(); ++mfi)
+		{
+		    const Box& bx = mfi.tilebox();
+
+		    ca_compute_multipole_moments_cached(ARLIM_3D(bx.loVect()), ARLIM_3D(bx.hiVect()),
+							BL_TO_FORTRAN_ANYD(source[mfi]),
+							BL_TO_FORTRAN_ANYD(basis[mfi]), &nbasis,
+							q);
+		}
+
+#ifdef _OPENMP
+#pragma omp barrier
+#pragma omp for
+#endif
+		for (int b = 0; b < nbasis; ++b)
+		    for (int it = 0; it < nthreads; ++it)
+		        q_cached[b] += priv_q[it * nbasis + b];
+	    }
+
+	    any_cached = true;
+
+	    continue;
+
+	}
+
 #ifdef _OPENMP
 	int nthreads = omp_get_max_threads();
 	Vector<std::unique_ptr<FArrayBox> > priv_qL0(nthreads);
@@ -1661,6 +1880,11 @@ Gravity::fill_multipole_BCs(int crse_level, int fine_level, const Vector<MultiFa
 
     } // end loop over levels
 
+    if (any_cached)
+        ca_unpack_multipole_moments(q_cached.dataPtr(), &nbasis, &lnum,
+                                    qL0.dataPtr(), qLC.dataPtr(), qLS.dataPtr(),
+                                    &npts);
+
     // Now, do a global reduce over all processes.
 
     ParallelDescriptor::ReduceRealSum(qL0.dataPtr(),boxq0.numPts());
@@ -1712,6 +1936,179 @@ Gravity::fill_multipole_BCs(int crse_level, int fine_level, const Vector<MultiFa
     }
 
 }
+
+bool
+Gravity::get_multipole_basis (int lev)
+{
+    // The basis depends on the grids, which install_level takes care
+    // of, and on the center, which may move from step to step.
+
+    std::array<Real,3> center;
+    ca_get_center(center.data());
+
+    if (multipole_basis[lev] && center == multipole_basis_center[lev])
+        return true;
+
+    multipole_basis[lev].reset();
+
+    if (multipole_cache_max_mb <= 0.0)
+        return false;
+
+    const MultiFab& vol = *volume[lev];
+
+    const int nbasis = (lnum + 1) * (lnum + 1);
+
+    long npts_local = 0;
+    for (MFIter mfi(vol); mfi.isValid(); ++mfi)
+        npts_local += mfi.validbox().numPts();
+
+    Real mb = static_cast<Real>(npts_local) * nbasis * sizeof(Real) / (1024.0 * 1024.0);
+
+    // Every rank has to make the same choice, since the sums below
+    // and the moment reduction differ between the two paths.
+    ParallelDescriptor::ReduceRealMax(mb);
+
+    if (mb > multipole_cache_max_mb)
+        return false;
+
+    const Real strt = ParallelDescriptor::second();
+
+#if (BL_SPACEDIM == 3)
+    const int npts = numpts_at_level;
+#else
+    const int npts = 1;
+#endif
+
+    const Box& domain = parent->Geom(lev).Domain();
+    const Real* dx = parent->Geom(lev).CellSize();
+
+    multipole_basis[lev].reset(new MultiFab(vol.boxArray(), vol.DistributionMap(), nbasis, 0));
+    multipole_basis_center[lev] = center;
+
+    MultiFab& basis = *multipole_basis[lev];
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(basis,true); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+
+        ca_compute_multipole_basis(ARLIM_3D(bx.loVect()), ARLIM_3D(bx.hiVect()),
+                                   ARLIM_3D(domain.loVect()), ARLIM_3D(domain.hiVect()),
+                                   ZFILL(dx), BL_TO_FORTRAN_ANYD(vol[mfi]),
+                                   BL_TO_FORTRAN_ANYD(basis[mfi]), &nbasis,
+                                   &lnum, &npts);
+    }
+
+    if (verbose > 1)
+    {
+        const int IOProc = ParallelDescriptor::IOProcessorNumber();
+        Real      end    = ParallelDescriptor::second() - strt;
+
+#ifdef BL_LAZY
+	Lazy::QueueReduction( [=] () mutable {
+#endif
+        ParallelDescriptor::ReduceRealMax(end,IOProc);
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << "Gravity::get_multipole_basis() level " << lev
+                      << " time = " << end << std::endl;
+#ifdef BL_LAZY
+	});
+#endif
+    }
+
+    return true;
+}
+#endif
+
+#if (BL_SPACEDIM == 3)
+void
+Gravity::get_radial_bins (int lev)
+{
+    // As for the multipole basis, the bins depend on the grids, which
+    // install_level takes care of, and on the center.
+
+    std::array<Real,3> center;
+    ca_get_center(center.data());
+
+    if (radial_bins[lev] && center == radial_bins_center[lev])
+        return;
+
+    const Real strt = ParallelDescriptor::second();
+
+    const Geometry& geom = parent->Geom(lev);
+    const Real* dx = geom.CellSize();
+    const Real dr = dx[0] / double(drdxfac);
+
+    const int n1d = radial_mass[lev].size();
+
+    // The sub-zone centers of a zone are at most sqrt(3) (drdxfac-1) dr
+    // apart, so they span at most this many bins.  The count in each
+    // bin is stored in 16 bits, two to an int.
+    const int nbins = static_cast<int>(std::sqrt(3.0) * (drdxfac - 1)) + 2;
+    const int nwords = (nbins + 1) / 2;
+
+    if (drdxfac * drdxfac * drdxfac > 65535)
+        amrex::Abort("Gravity::get_radial_bins: drdxfac must be at most 40");
+
+    radial_bins[lev].reset(new iMultiFab(grids[lev], dmap[lev], nwords + 1, 0));
+    radial_bins_center[lev] = center;
+
+    iMultiFab& bins = *radial_bins[lev];
+
+    radial_bins_dvol[lev] = 0.0;
+
+    Vector<Real>& vol = radial_bins_vol[lev];
+    vol.assign(n1d, 0.0);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        Vector<Real> priv_vol(n1d, 0.0);
+        Real priv_dvol = 0.0;
+
+        for (MFIter mfi(bins,true); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.tilebox();
+
+            ca_compute_radial_bins(ARLIM_3D(bx.loVect()), ARLIM_3D(bx.hiVect()),
+                                   ZFILL(dx), &dr,
+                                   BL_TO_FORTRAN_ANYD(bins[mfi]), &nbins, &nwords,
+                                   &priv_dvol, priv_vol.dataPtr(),
+                                   geom.ProbLo(), &n1d, &drdxfac, &lev);
+        }
+
+#ifdef _OPENMP
+#pragma omp critical (radial_bins_vol)
+#endif
+        {
+            for (int i = 0; i < n1d; i++)
+                vol[i] += priv_vol[i];
+            radial_bins_dvol[lev] = std::max(radial_bins_dvol[lev], priv_dvol);
+        }
+    }
+
+    ParallelDescriptor::ReduceRealSum(vol.dataPtr(), n1d);
+
+    if (verbose > 1)
+    {
+        const int IOProc = ParallelDescriptor::IOProcessorNumber();
+        Real      end    = ParallelDescriptor::second() - strt;
+
+#ifdef BL_LAZY
+	Lazy::QueueReduction( [=] () mutable {
+#endif
+        ParallelDescriptor::ReduceRealMax(end,IOProc);
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << "Gravity::get_radial_bins() level " << lev
+                      << " time = " << end << std::endl;
+#ifdef BL_LAZY
+	});
+#endif
+    }
+}
 #endif
 
 #if (BL_SPACEDIM == 3)
@@ -1736,7 +2133,7 @@ Gravity::fill_direct_sum_BCs(int crse_level, int fine_level, const Vector<MultiF
     const int hiVectXZ[3] = {domhi[0]+1, 0         , domhi[2]+1};
 
     const int loVectYZ[3] = {0         , domlo[1]-1, domlo[2]-1};
-    const int hiVectYZ[3] = {0         , domhi[1]+1, domhi[1]+1};
+    const int hiVectYZ[3] = {0         , domhi[1]+1, domhi[2]+1};
 
     const int bclo[3] = {domlo[0]-1, domlo[1]-1, domlo[2]-1};
     const int bchi[3] = {domhi[0]+1, domhi[1]+1, domhi[2]+1};
@@ -1787,7 +2184,63 @@ Gravity::fill_direct_sum_BCs(int crse_level, int fine_level, const Vector<MultiF
 
     int symmetry_type = Symmetry;
 
-    for (int lev = crse_level; lev <= fine_level; ++lev) {
+    // With direct_sum_theta > 0 we use the tree code in place of the
+    // direct sum, unless we are checking one against the other.
+
+    const bool use_tree = direct_sum_theta > 0.0;
+    const bool do_exact = !use_tree || direct_sum_check;
+
+    FArrayBox treeXYLo, treeXYHi, treeXZLo, treeXZHi, treeYZLo, treeYZHi;
+
+    Real tree_time = 0.0;
+
+    if (use_tree) {
+
+        const Real tree_strt = ParallelDescriptor::second();
+
+        FArrayBox* tXYLo = &bcXYLo;
+        FArrayBox* tXYHi = &bcXYHi;
+        FArrayBox* tXZLo = &bcXZLo;
+        FArrayBox* tXZHi = &bcXZHi;
+        FArrayBox* tYZLo = &bcYZLo;
+        FArrayBox* tYZHi = &bcYZHi;
+
+        if (do_exact) {
+            treeXYLo.resize(boxXY); tXYLo = &treeXYLo;
+            treeXYHi.resize(boxXY); tXYHi = &treeXYHi;
+            treeXZLo.resize(boxXZ); tXZLo = &treeXZLo;
+            treeXZHi.resize(boxXZ); tXZHi = &treeXZHi;
+            treeYZLo.resize(boxYZ); tYZLo = &treeYZLo;
+            treeYZHi.resize(boxYZ); tYZHi = &treeYZHi;
+
+            // The tree sum accumulates into these.
+            treeXYLo.setVal(0.0);
+            treeXYHi.setVal(0.0);
+            treeXZLo.setVal(0.0);
+            treeXZHi.setVal(0.0);
+            treeYZLo.setVal(0.0);
+            treeYZHi.setVal(0.0);
+        }
+
+        fill_direct_sum_BCs_tree(crse_level, fine_level, Rhs,
+                                 *tXYLo, *tXYHi, *tXZLo, *tXZHi, *tYZLo, *tYZHi);
+
+        if (do_exact) {
+            ParallelDescriptor::ReduceRealSum(treeXYLo.dataPtr(), nPtsXY);
+            ParallelDescriptor::ReduceRealSum(treeXYHi.dataPtr(), nPtsXY);
+            ParallelDescriptor::ReduceRealSum(treeXZLo.dataPtr(), nPtsXZ);
+            ParallelDescriptor::ReduceRealSum(treeXZHi.dataPtr(), nPtsXZ);
+            ParallelDescriptor::ReduceRealSum(treeYZLo.dataPtr(), nPtsYZ);
+            ParallelDescriptor::ReduceRealSum(treeYZHi.dataPtr(), nPtsYZ);
+        }
+
+        tree_time = ParallelDescriptor::second() - tree_strt;
+
+    }
+
+    const Real exact_strt = ParallelDescriptor::second();
+
+    for (int lev = crse_level; lev <= fine_level && do_exact; ++lev) {
 
 	// Create a local copy of the RHS so that we can mask it.
 
@@ -1911,6 +2364,35 @@ Gravity::fill_direct_sum_BCs(int crse_level, int fine_level, const Vector<MultiF
     ParallelDescriptor::ReduceRealSum(bcYZLo.dataPtr(), nPtsYZ);
     ParallelDescriptor::ReduceRealSum(bcYZHi.dataPtr(), nPtsYZ);
 
+    if (use_tree && do_exact) {
+
+        // Compare the tree code with the direct sum, and then use the
+        // tree values, as we would have without the check.
+
+        const Real exact_time = ParallelDescriptor::second() - exact_strt;
+
+        Real err = 0.0;
+
+        FArrayBox* exact[6] = { &bcXYLo, &bcXYHi, &bcXZLo, &bcXZHi, &bcYZLo, &bcYZHi };
+        FArrayBox* tree[6]  = { &treeXYLo, &treeXYHi, &treeXZLo, &treeXZHi, &treeYZLo, &treeYZHi };
+
+        for (int f = 0; f < 6; ++f) {
+            const Real* pe = exact[f]->dataPtr();
+            const Real* pt = tree[f]->dataPtr();
+            const long npts = exact[f]->box().numPts();
+            for (long i = 0; i < npts; ++i)
+                if (pe[i] != 0.0)
+                    err = std::max(err, std::abs(pt[i] - pe[i]) / std::abs(pe[i]));
+            exact[f]->copy(*tree[f]);
+        }
+
+        amrex::Print() << "Gravity::fill_direct_sum_BCs(): theta = " << direct_sum_theta
+                       << ", max rel. difference from the direct sum = " << err << std::endl
+                       << "    tree time = " << tree_time
+                       << ", direct sum time = " << exact_time << std::endl;
+
+    }
+
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -1945,6 +2427,146 @@ Gravity::fill_direct_sum_BCs(int crse_level, int fine_level, const Vector<MultiF
     }
 
 }
+
+void
+Gravity::fill_direct_sum_BCs_tree(int crse_level, int fine_level, const Vector<MultiFab*>& Rhs,
+                                  FArrayBox& bcXYLo, FArrayBox& bcXYHi,
+                                  FArrayBox& bcXZLo, FArrayBox& bcXZHi,
+                                  FArrayBox& bcYZLo, FArrayBox& bcYZHi)
+{
+    BL_PROFILE("Gravity::fill_direct_sum_BCs_tree()");
+
+    const Geometry& crse_geom = parent->Geom(crse_level);
+
+    const Real* problo = crse_geom.ProbLo();
+    const Real* probhi = crse_geom.ProbHi();
+    const Real* bcdx   = crse_geom.CellSize();
+
+    const int* domlo = crse_geom.Domain().loVect();
+    const int* domhi = crse_geom.Domain().hiVect();
+
+    const int bclo[3] = {domlo[0]-1, domlo[1]-1, domlo[2]-1};
+    const int bchi[3] = {domhi[0]+1, domhi[1]+1, domhi[2]+1};
+
+    // Mass hidden behind a symmetry boundary is added as images,
+    // reflected in every combination of the symmetric lo faces, and
+    // separately of the symmetric hi faces, as direct_sum_symmetric_add
+    // does for the direct sum.
+
+    bool sym_lo[3], sym_hi[3];
+    for (int dir = 0; dir < 3; dir++) {
+        sym_lo[dir] = phys_bc->lo(dir) == Symmetry;
+        sym_hi[dir] = phys_bc->hi(dir) == Symmetry;
+    }
+
+    // Each rank builds a tree over its own zones; the sum over ranks is
+    // done by the caller, as for the direct sum.
+
+    GravityTree tree;
+
+    for (int lev = crse_level; lev <= fine_level; ++lev) {
+
+        MultiFab source(Rhs[lev - crse_level]->boxArray(),
+                        Rhs[lev - crse_level]->DistributionMap(),
+                        1, 0);
+
+        MultiFab::Copy(source, *Rhs[lev - crse_level], 0, 0, 1, 0);
+
+        if (lev < fine_level) {
+            const MultiFab& mask = dynamic_cast<Castro*>(&(parent->getLevel(lev+1)))->build_fine_mask();
+            MultiFab::Multiply(source, mask, 0, 0, 1, 0);
+        }
+
+        const Real* dx = parent->Geom(lev).CellSize();
+
+        for (MFIter mfi(source); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.validbox();
+            const FArrayBox& r = source[mfi];
+            const FArrayBox& v = (*volume[lev])[mfi];
+
+            for (BoxIterator bit(bx); bit.ok(); ++bit)
+            {
+                const IntVect& iv = bit();
+
+                const Real m = r(iv) * v(iv);
+                if (m == 0.0) continue;
+
+                Real loc[3];
+                for (int dir = 0; dir < 3; dir++)
+                    loc[dir] = problo[dir] + (iv[dir] + 0.5) * dx[dir];
+
+                tree.addMass(loc[0], loc[1], loc[2], m);
+
+                for (int side = 0; side < 2; side++) {
+                    const bool* sym = side == 0 ? sym_lo : sym_hi;
+                    const Real* edge = side == 0 ? problo : probhi;
+                    for (int set = 1; set < 8; set++) {
+                        bool ok = true;
+                        Real img[3] = { loc[0], loc[1], loc[2] };
+                        for (int dir = 0; dir < 3; dir++) {
+                            if (set & (1 << dir)) {
+                                ok = ok && sym[dir];
+                                img[dir] = 2.0 * edge[dir] - loc[dir];
+                            }
+                        }
+                        if (ok) tree.addMass(img[0], img[1], img[2], m);
+                    }
+                }
+            }
+        }
+
+    }
+
+    tree.build();
+
+    Real Gconst;
+    get_grav_const(&Gconst);
+
+    const Real theta = direct_sum_theta;
+
+    // The boundary values live on the faces; the corners of each face
+    // are at the domain edges.
+
+    auto bc_loc = [&] (int dir, int i) -> Real {
+        if (i == bclo[dir]) return problo[dir];
+        if (i == bchi[dir]) return probhi[dir];
+        return problo[dir] + (i + 0.5) * bcdx[dir];
+    };
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int m = bclo[1]; m <= bchi[1]; ++m) {
+        for (int l = bclo[0]; l <= bchi[0]; ++l) {
+            const IntVect iv(l, m, 0);
+            bcXYLo(iv) += -Gconst * tree.potential(bc_loc(0, l), bc_loc(1, m), problo[2], theta);
+            bcXYHi(iv) += -Gconst * tree.potential(bc_loc(0, l), bc_loc(1, m), probhi[2], theta);
+        }
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int n = bclo[2]; n <= bchi[2]; ++n) {
+        for (int l = bclo[0]; l <= bchi[0]; ++l) {
+            const IntVect iv(l, 0, n);
+            bcXZLo(iv) += -Gconst * tree.potential(bc_loc(0, l), problo[1], bc_loc(2, n), theta);
+            bcXZHi(iv) += -Gconst * tree.potential(bc_loc(0, l), probhi[1], bc_loc(2, n), theta);
+        }
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int n = bclo[2]; n <= bchi[2]; ++n) {
+        for (int m = bclo[1]; m <= bchi[1]; ++m) {
+            const IntVect iv(0, m, n);
+            bcYZLo(iv) += -Gconst * tree.potential(problo[0], bc_loc(1, m), bc_loc(2, n), theta);
+            bcYZHi(iv) += -Gconst * tree.potential(probhi[0], bc_loc(1, m), bc_loc(2, n), theta);
+        }
+    }
+}
 #endif
 
 #if (BL_SPACEDIM < 3)
@@ -2174,8 +2796,21 @@ Gravity::make_radial_gravity(int level, Real time, Vector<Real>& radial_grav)
 
 	const int NUM_STATE = LevelData[lev]->get_new_data(State_Type).nComp();
 
-        // Create MultiFab with NUM_STATE components and no ghost cells
-        MultiFab S(grids[lev],dmap[lev],NUM_STATE,0);
+#if (BL_SPACEDIM == 3) && !defined(GR_GRAV)
+        // The cached bins only need the density.
+        const int scomp = Density;
+        const int ncomp = 1;
+        const int rho_comp = 0;
+#else
+        const int scomp = 0;
+        const int ncomp = NUM_STATE;
+#if (BL_SPACEDIM == 3)
+        const int rho_comp = Density;
+#endif
+#endif
+
+        // Create MultiFab with ncomp components and no ghost cells
+        MultiFab S(grids[lev],dmap[lev],ncomp,0);
 
 	if ( eps == 0.0 )
 	{
@@ -2183,29 +2818,29 @@ Gravity::make_radial_gravity(int level, Real time, Vector<Real>& radial_grav)
             // dt is smaller than roundoff compared to the current time,
             // in which case we're probably in trouble anyway,
             // but we will still handle it gracefully here.
-            S.copy(LevelData[lev]->get_new_data(State_Type),0,0,NUM_STATE);
+            S.copy(LevelData[lev]->get_new_data(State_Type),scomp,0,ncomp);
 	}
         else if ( std::abs(time-t_old) < eps)
         {
-            S.copy(LevelData[lev]->get_old_data(State_Type),0,0,NUM_STATE);
+            S.copy(LevelData[lev]->get_old_data(State_Type),scomp,0,ncomp);
         }
         else if ( std::abs(time-t_new) < eps)
         {
-            S.copy(LevelData[lev]->get_new_data(State_Type),0,0,NUM_STATE);
+            S.copy(LevelData[lev]->get_new_data(State_Type),scomp,0,ncomp);
         }
         else if (time > t_old && time < t_new)
         {
             Real alpha   = (time - t_old)/(t_new - t_old);
             Real omalpha = 1.0 - alpha;
 
-            S.copy(LevelData[lev]->get_old_data(State_Type),0,0,NUM_STATE);
+            S.copy(LevelData[lev]->get_old_data(State_Type),scomp,0,ncomp);
             S.mult(omalpha);
 
-            MultiFab S_new(grids[lev],dmap[lev],NUM_STATE,0);
-            S_new.copy(LevelData[lev]->get_new_data(State_Type),0,0,NUM_STATE);
+            MultiFab S_new(grids[lev],dmap[lev],ncomp,0);
+            S_new.copy(LevelData[lev]->get_new_data(State_Type),scomp,0,ncomp);
             S_new.mult(alpha);
 
-            S.plus(S_new,0,NUM_STATE,0);
+            S.plus(S_new,0,ncomp,0);
         }
         else
         {
@@ -2218,16 +2853,30 @@ Gravity::make_radial_gravity(int level, Real time, Vector<Real>& radial_grav)
         {
 	    Castro* fine_level = dynamic_cast<Castro*>(&(parent->getLevel(lev+1)));
 	    const MultiFab& mask = fine_level->build_fine_mask();
-	    for (int n = 0; n < NUM_STATE; ++n)
+	    for (int n = 0; n < ncomp; ++n)
 		MultiFab::Multiply(S, mask, 0, n, 1, 0);
         }
 
         int n1d = radial_mass[lev].size();
 
+#if (BL_SPACEDIM == 3)
+        // The bins only change on regrid, or when the center moves, and
+        // they know the volume of each bin already.
+
+        get_radial_bins(lev);
+
+        const iMultiFab& bins = *radial_bins[lev];
+        const int nwords = bins.nComp() - 1;
+        const int nbins = static_cast<int>(std::sqrt(3.0) * (drdxfac - 1)) + 2;
+
+        radial_vol[lev] = radial_bins_vol[lev];
+#else
+        for (int i = 0; i < n1d; i++) radial_vol[lev][i] = 0.;
+#endif
+
 #ifdef GR_GRAV
         for (int i = 0; i < n1d; i++) radial_pres[lev][i] = 0.;
 #endif
-        for (int i = 0; i < n1d; i++) radial_vol[lev][i] = 0.;
         for (int i = 0; i < n1d; i++) radial_mass[lev][i] = 0.;
 
         const Geometry& geom = parent->Geom(lev);
@@ -2240,13 +2889,17 @@ Gravity::make_radial_gravity(int level, Real time, Vector<Real>& radial_grav)
 	Vector< Vector<Real> > priv_radial_pres(nthreads);
 #endif
 	Vector< Vector<Real> > priv_radial_mass(nthreads);
+#if (BL_SPACEDIM < 3)
 	Vector< Vector<Real> > priv_radial_vol (nthreads);
+#endif
 	for (int i=0; i<nthreads; i++) {
 #ifdef GR_GRAV
 	    priv_radial_pres[i].resize(n1d,0.0);
 #endif
 	    priv_radial_mass[i].resize(n1d,0.0);
+#if (BL_SPACEDIM < 3)
 	    priv_radial_vol [i].resize(n1d,0.0);
+#endif
 	}
 #pragma omp parallel
 #endif
@@ -2259,6 +2912,18 @@ Gravity::make_radial_gravity(int level, Real time, Vector<Real>& radial_grav)
 	        const Box& bx = mfi.tilebox();
 		FArrayBox& fab = S[mfi];
 
+#if (BL_SPACEDIM == 3)
+		ca_compute_radial_mass_cached(ARLIM_3D(bx.loVect()), ARLIM_3D(bx.hiVect()),
+					      BL_TO_FORTRAN_N_ANYD(fab, rho_comp),
+					      BL_TO_FORTRAN_ANYD(bins[mfi]), &nbins, &nwords,
+					      &radial_bins_dvol[lev],
+#ifdef _OPENMP
+					      priv_radial_mass[tid].dataPtr(),
+#else
+					      radial_mass[lev].dataPtr(),
+#endif
+					      &n1d);
+#else
 		ca_compute_radial_mass(bx.loVect(), bx.hiVect(), dx, &dr,
 				       BL_TO_FORTRAN(fab),
 #ifdef _OPENMP
@@ -2269,6 +2934,7 @@ Gravity::make_radial_gravity(int level, Real time, Vector<Real>& radial_grav)
 				       radial_vol[lev].dataPtr(),
 #endif
 				       geom.ProbLo(),&n1d,&drdxfac,&lev);
+#endif
 
 #ifdef GR_GRAV
 		ca_compute_avgpres(bx.loVect(), bx.hiVect(), dx, &dr,
@@ -2291,17 +2957,38 @@ Gravity::make_radial_gravity(int level, Real time, Vector<Real>& radial_grav)
 	            radial_pres[lev][i] += priv_radial_pres[it][i];
 #endif
 	            radial_mass[lev][i] += priv_radial_mass[it][i];
+#if (BL_SPACEDIM < 3)
 		    radial_vol [lev][i] += priv_radial_vol [it][i];
+#endif
 		}
 	    }
 #endif
 	}
 
-        ParallelDescriptor::ReduceRealSum(radial_mass[lev].dataPtr() ,n1d);
-        ParallelDescriptor::ReduceRealSum(radial_vol[lev].dataPtr()  ,n1d);
+        // One reduction for everything binned on this level.
+
+        {
+            Vector<Real> sums(radial_mass[lev]);
+#if (BL_SPACEDIM < 3)
+            sums.insert(sums.end(), radial_vol[lev].begin(), radial_vol[lev].end());
+#endif
 #ifdef GR_GRAV
-        ParallelDescriptor::ReduceRealSum(radial_pres[lev].dataPtr()  ,n1d);
+            sums.insert(sums.end(), radial_pres[lev].begin(), radial_pres[lev].end());
 #endif
+            ParallelDescriptor::ReduceRealSum(sums.dataPtr(), sums.size());
+
+            auto it = sums.begin();
+            std::copy(it, it + n1d, radial_mass[lev].begin());
+            it += n1d;
+#if (BL_SPACEDIM < 3)
+            std::copy(it, it + n1d, radial_vol[lev].begin());
+            it += n1d;
+#endif
+#ifdef GR_GRAV
+            std::copy(it, it + n1d, radial_pres[lev].begin());
+            it += n1d;
+#endif
+        }
 
         if (do_diag > 0)
         {
@@ -2564,7 +3251,7 @@ Gravity::solve_phi_with_mlmg (int crse_level, int fine_level,
                               const Vector<MultiFab*>& rhs,
                               const Vector<Vector<MultiFab*> >& grad_phi,
                               const Vector<MultiFab*>& res,
-                              Real time)
+                              Real time, int fixed_iter)
 {
     BL_PROFILE("Gravity::solve_phi_with_mlmg()");
 
@@ -2627,7 +3314,7 @@ Gravity::solve_phi_with_mlmg (int crse_level, int fine_level,
     }
 
     return actual_solve_with_mlmg(crse_level, fine_level, phi, crhs, gp, res,
-                                  crse_bcdata, rel_eps, abs_eps);
+                                  crse_bcdata, rel_eps, abs_eps, fixed_iter);
 }
 
 void
@@ -2669,7 +3356,8 @@ Gravity::actual_solve_with_mlmg (int crse_level, int fine_level,
                                  const amrex::Vector<std::array<amrex::MultiFab*,AMREX_SPACEDIM> >& grad_phi,
                                  const amrex::Vector<amrex::MultiFab*>& res,
                                  const amrex::MultiFab* const crse_bcdata,
-                                 amrex::Real rel_eps, amrex::Real abs_eps)
+                                 amrex::Real rel_eps, amrex::Real abs_eps,
+                                 int fixed_iter)
 {
     BL_PROFILE("Gravity::acutal_solve_with_mlmg()");
 
@@ -2713,6 +3401,12 @@ Gravity::actual_solve_with_mlmg (int crse_level, int fine_level,
 	mlmg.setMaxFmgIter(0); // Vcycle
     }
 
+    if (fixed_iter > 0) {
+        // Just this many V-cycles from the current phi.
+        mlmg.setMaxFmgIter(0);
+        mlmg.setFixedIter(fixed_iter);
+    }
+
     AMREX_ALWAYS_ASSERT( !grad_phi.empty() or !res.empty() );
     AMREX_ALWAYS_ASSERT(  grad_phi.empty() or  res.empty() );
 
@@ -2722,6 +3416,7 @@ Gravity::actual_solve_with_mlmg (int crse_level, int fine_level,
 
         mlmg.setNSolve(mlmg_nsolve);
         final_resnorm = mlmg.solve(phi, rhs, rel_eps, abs_eps);
+        last_mlmg_iters = mlmg.getNumIters();
 
         mlmg.getGradSolution(grad_phi);
     }
@@ -153,6 +153,202 @@ contains
 
 
 
+  ! The part of ca_compute_radial_mass that only depends on the grid:
+  ! for each zone, the first radial bin its sub-zones fall in, and the
+  ! number of its sub-zones in that bin and the nbins-1 after it,
+  !
+  !   bins(i,j,k,0)          first bin
+  !   bins(i,j,k,1:nwords)   counts in bins first, ..., first+nbins-1,
+  !                          two 16-bit counts to a word
+  !
+  ! nbins must be at least int(sqrt(3) * (drdxfac-1)) + 2, and nwords
+  ! (nbins+1)/2.  The volume of a sub-zone is returned in dvol and the
+  ! volumes are also added to radial_vol.
+
+  subroutine ca_compute_radial_bins (lo,hi,dx,dr, &
+                                     bins,b_lo,b_hi,nbins,nwords, &
+                                     dvol,radial_vol,problo,n1d,drdxfac,level) &
+                                     bind(C, name="ca_compute_radial_bins")
+
+    use amrex_constants_module
+    use prob_params_module, only: center
+
+    use amrex_fort_module, only : rt => amrex_real
+    implicit none
+
+    integer , intent(in   ) :: lo(3),hi(3)
+    real(rt), intent(in   ) :: dx(3),dr
+    real(rt), intent(in   ) :: problo(3)
+
+    integer , intent(in   ) :: b_lo(3),b_hi(3),nbins,nwords
+    integer , intent(inout) :: bins(b_lo(1):b_hi(1),b_lo(2):b_hi(2),b_lo(3):b_hi(3),0:nwords)
+
+    integer , intent(in   ) :: n1d,drdxfac,level
+    real(rt), intent(inout) :: dvol
+    real(rt), intent(inout) :: radial_vol(0:n1d-1)
+
+    integer          :: i,j,k,n,w,index,first
+    integer          :: cnt(2*nwords)
+    integer          :: ii,jj,kk
+    real(rt)         :: xc,yc,zc,r,xxsq,yysq,zzsq,octant_factor
+    real(rt)         :: fac,xx,yy,zz,dx_frac,dy_frac,dz_frac
+    real(rt)         :: vol_frac, drinv, rmin
+    real(rt)         :: lo_i,lo_j,lo_k
+
+    if (( abs(center(1) - problo(1)) .lt. 1.e-2_rt * dx(1) ) .and. &
+         ( abs(center(2) - problo(2)) .lt. 1.e-2_rt * dx(2) ) .and. &
+         ( abs(center(3) - problo(3)) .lt. 1.e-2_rt * dx(3) ) ) then
+       octant_factor = EIGHT
+    else
+       octant_factor = ONE
+    end if
+
+    drinv = ONE/dr
+
+    fac     = dble(drdxfac)
+    dx_frac = dx(1) / fac
+    dy_frac = dx(2) / fac
+    dz_frac = dx(3) / fac
+
+    vol_frac = octant_factor * dx_frac * dy_frac * dz_frac
+    dvol = vol_frac
+
+    do k = lo(3), hi(3)
+       zc = problo(3) + (dble(k)+HALF) * dx(3) - center(3)
+       lo_k =  problo(3) + dble(k)*dx(3) - center(3)
+
+       do j = lo(2), hi(2)
+          yc = problo(2) + (dble(j)+HALF) * dx(2) - center(2)
+          lo_j =  problo(2) + dble(j)*dx(2) - center(2)
+
+          do i = lo(1), hi(1)
+             xc  = problo(1) + (dble(i)+HALF) * dx(1) - center(1)
+             lo_i =  problo(1) + dble(i)*dx(1) - center(1)
+
+             bins(i,j,k,:) = 0
+
+             r = sqrt(xc**2 + yc**2 + zc**2)
+             index = int(r*drinv)
+
+             if (index .gt. n1d-1) then
+
+                if (level .eq. 0) then
+                   print *,'   '
+                   print *,'>>> Error: Gravity_3d::ca_compute_radial_bins ',i,j,k
+                   print *,'>>> ... index too big: ', index,' > ',n1d-1
+                   print *,'>>> ... at (i,j,k)   : ',i,j,k
+                   call amrex_error("Error:: Gravity_3d.f90 :: ca_compute_radial_bins")
+                end if
+
+             else
+
+                ! The sub-zone nearest the center is in the first bin.
+
+                rmin = HUGE(ONE)
+                do kk = 0,drdxfac-1
+                   zz = lo_k + (dble(kk)+HALF)*dz_frac
+                   do jj = 0,drdxfac-1
+                      yy = lo_j + (dble(jj)+HALF)*dy_frac
+                      do ii = 0,drdxfac-1
+                         xx = lo_i + (dble(ii)+HALF)*dx_frac
+                         rmin = min(rmin, sqrt(xx*xx + yy*yy + zz*zz))
+                      end do
+                   end do
+                end do
+
+                first = int(rmin*drinv)
+                bins(i,j,k,0) = first
+
+                cnt = 0
+
+                do kk = 0,drdxfac-1
+                   zz   = lo_k + (dble(kk)+HALF)*dz_frac
+                   zzsq = zz*zz
+                   do jj = 0,drdxfac-1
+                      yy   = lo_j + (dble(jj)+HALF)*dy_frac
+                      yysq = yy*yy
+                      do ii = 0,drdxfac-1
+
+                         xx    = lo_i + (dble(ii)+HALF)*dx_frac
+                         xxsq  = xx*xx
+                         r     = sqrt(xxsq  + yysq + zzsq)
+                         index = int(r*drinv)
+
+                         if (index .le. n1d-1) then
+                            n = index - first + 1
+                            if (n .gt. nbins) then
+                               call amrex_error("Error:: Gravity_3d.f90 :: ca_compute_radial_bins: nbins too small")
+                            end if
+                            cnt(n) = cnt(n) + 1
+                            radial_vol(index) = radial_vol(index) + vol_frac
+                         end if
+                      end do
+                   end do
+                end do
+
+                ! Two 16-bit counts to a word, the lower bin in the low bits.
+
+                do w = 1, nwords
+                   bins(i,j,k,w) = ior(cnt(2*w-1), ishft(cnt(2*w), 16))
+                end do
+
+             end if
+          enddo
+       enddo
+    enddo
+
+  end subroutine ca_compute_radial_bins
+
+
+
+  ! ca_compute_radial_mass using the bins from ca_compute_radial_bins:
+  ! each zone adds dvol * rho * (its sub-zone count in a bin) to the bin.
+
+  subroutine ca_compute_radial_mass_cached (lo,hi, &
+                                            rho,r_lo,r_hi, &
+                                            bins,b_lo,b_hi,nbins,nwords, &
+                                            dvol,radial_mass,n1d) &
+                                            bind(C, name="ca_compute_radial_mass_cached")
+
+    use amrex_fort_module, only : rt => amrex_real
+    implicit none
+
+    integer , intent(in   ) :: lo(3),hi(3)
+    integer , intent(in   ) :: r_lo(3),r_hi(3)
+    integer , intent(in   ) :: b_lo(3),b_hi(3),nbins,nwords
+    integer , intent(in   ) :: n1d
+    real(rt), intent(in   ) :: rho(r_lo(1):r_hi(1),r_lo(2):r_hi(2),r_lo(3):r_hi(3))
+    integer , intent(in   ) :: bins(b_lo(1):b_hi(1),b_lo(2):b_hi(2),b_lo(3):b_hi(3),0:nwords)
+    real(rt), intent(in   ) :: dvol
+    real(rt), intent(inout) :: radial_mass(0:n1d-1)
+
+    integer          :: i,j,k,n,w,word,first,last
+    real(rt)         :: rvol
+
+    do k = lo(3), hi(3)
+       do j = lo(2), hi(2)
+          do i = lo(1), hi(1)
+             first = bins(i,j,k,0)
+             last = min(first + nbins - 1, n1d - 1)
+             rvol = dvol * rho(i,j,k)
+             n = first
+             do w = 1, nwords
+                if (n .gt. last) exit
+                word = bins(i,j,k,w)
+                radial_mass(n) = radial_mass(n) + rvol * iand(word, 65535)
+                if (n+1 .le. last) then
+                   radial_mass(n+1) = radial_mass(n+1) + rvol * ishft(word, -16)
+                end if
+                n = n + 2
+             end do
+          enddo
+       enddo
+    enddo
+
+  end subroutine ca_compute_radial_mass_cached
+
+
+
   subroutine ca_put_radial_grav (lo,hi,dx,dr,&
        grav,g_l1,g_l2,g_l3,g_h1,g_h2,g_h3, &
        radial_grav,problo,n1d,level) bind(C, name="ca_put_radial_grav")
@@ -448,7 +644,7 @@ contains
                    if (l .eq. bclo(1)) then
                       locb(1) = problo(1)
                    else if (l .eq. bchi(1)) then
-                      locb(1) = probhi(2)
+                      locb(1) = probhi(1)
                    else
                       locb(1) = problo(1) + (dble(l)+HALF) * bcdx(1)
                    endif
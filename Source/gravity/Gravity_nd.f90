@@ -449,7 +449,7 @@ contains
     integer          :: l, m, n, nlo
     real(rt)         :: x, y, z, r, cosTheta, phiAngle
     real(rt)         :: legPolyArr(0:lnum), assocLegPolyArr(0:lnum,0:lnum)
-    real(rt)         :: r_L, r_U
+    real(rt)         :: cosm(0:lnum), sinm(0:lnum), r_L(0:lnum), r_U(0:lnum)
 
     ! If we're using this to construct boundary values, then only use
     ! the outermost bin.
@@ -537,21 +537,20 @@ contains
                 legPolyArr = legPolyArr * rmax**3
                 assocLegPolyArr = assocLegPolyArr * rmax**3
 
+                call fill_trig_and_power_arrays(cosm, sinm, r_L, r_U, phiAngle, r, lnum)
+
                 ! Now compute the potentials on the ghost cells.
 
                 do n = nlo, npts-1
 
                    do l = 0, lnum
 
-                      r_L = r**dble( l  )
-                      r_U = r**dble(-l-1)
-
-                      phi(i,j,k) = phi(i,j,k) + qL0(l,n) * legPolyArr(l) * r_U
+                      phi(i,j,k) = phi(i,j,k) + qL0(l,n) * legPolyArr(l) * r_U(l)
 
                       do m = 1, l
 
-                         phi(i,j,k) = phi(i,j,k) + (qLC(l,m,n) * cos(m * phiAngle) + qLS(l,m,n) * sin(m * phiAngle)) * &
-                                      assocLegPolyArr(l,m) * r_U
+                         phi(i,j,k) = phi(i,j,k) + (qLC(l,m,n) * cosm(m) + qLS(l,m,n) * sinm(m)) * &
+                                      assocLegPolyArr(l,m) * r_U(l)
 
                       enddo
 
@@ -668,6 +667,209 @@ contains
 
 
 
+  ! The boundary moments are linear in the density, and the weight each
+  ! zone gets -- its volume times the Legendre polynomials, r**l and
+  ! cos(m phi), sin(m phi), plus the same for its images across any
+  ! symmetric boundaries -- only depends on the grid.  So we store those
+  ! weights, one component per moment, and then each step the moments
+  ! are just a matrix-vector product with the density.  The components
+  ! are ordered as the q0 moments (l = 0, lnum), then the qC moments and
+  ! then the qS moments (l = 1, lnum, m = 1, l), (lnum+1)**2 in all.
+  ! Only the outermost radial bin is kept, so this is for boundary_only.
+
+  subroutine ca_compute_multipole_basis (lo,hi,domlo,domhi,dx, &
+                                         vol,v_lo,v_hi, &
+                                         basis,b_lo,b_hi,nbasis, &
+                                         lnum,npts) &
+                                         bind(C, name="ca_compute_multipole_basis")
+
+    use prob_params_module, only: problo, center, probhi, dim, coord_type
+    use amrex_constants_module
+
+    use amrex_fort_module, only : rt => amrex_real
+    implicit none
+
+    integer , intent(in   ) :: lo(3),hi(3)
+    integer , intent(in   ) :: domlo(3),domhi(3)
+    real(rt), intent(in   ) :: dx(3)
+    integer , intent(in   ) :: lnum, npts, nbasis
+
+    integer , intent(in   ) :: v_lo(3), v_hi(3)
+    integer , intent(in   ) :: b_lo(3), b_hi(3)
+    real(rt), intent(in   ) :: vol(v_lo(1):v_hi(1),v_lo(2):v_hi(2),v_lo(3):v_hi(3))
+    real(rt), intent(inout) :: basis(b_lo(1):b_hi(1),b_lo(2):b_hi(2),b_lo(3):b_hi(3),0:nbasis-1)
+
+    integer          :: i, j, k, l, m, b, ncs
+    integer          :: index
+
+    real(rt)         :: x, y, z, r, drInv, cosTheta, phiAngle
+
+    real(rt)         :: qL0(0:lnum,0:0), qLC(0:lnum,0:lnum,0:0), qLS(0:lnum,0:lnum,0:0)
+    real(rt)         :: qU0(0:lnum,0:0), qUC(0:lnum,0:lnum,0:0), qUS(0:lnum,0:lnum,0:0)
+
+    if (lnum > lnum_max) then
+       call amrex_error("Error: ca_compute_multipole_basis: requested more multipole moments than we allocated data for.")
+    endif
+
+    if (nbasis /= (lnum+1)**2) then
+       call amrex_error("Error: ca_compute_multipole_basis: nbasis must be (lnum+1)**2.")
+    endif
+
+    drInv = rmax / dx(1)
+
+    ncs = (lnum * (lnum+1)) / 2
+
+    do k = lo(3), hi(3)
+       z = ( problo(3) + (dble(k)+HALF) * dx(3) - center(3) ) / rmax
+
+       do j = lo(2), hi(2)
+          y = ( problo(2) + (dble(j)+HALF) * dx(2) - center(2) ) / rmax
+
+          do i = lo(1), hi(1)
+             x = ( problo(1) + (dble(i)+HALF) * dx(1) - center(1) ) / rmax
+
+             r = sqrt( x**2 + y**2 + z**2 )
+
+             ! Here there is only the one bin, the outermost, so index
+             ! just says whether the zone is inside it (0) or not (1).
+
+             if (dim .eq. 3) then
+                index = int(r * drInv)
+                cosTheta = z / r
+                phiAngle = atan2(y, x)
+             else if (dim .eq. 2 .and. coord_type .eq. 1) then
+                index = npts-1
+                cosTheta = y / r
+                phiAngle = z
+             endif
+
+             if (index .le. npts-1) then
+                index = 0
+             else
+                index = 1
+             endif
+
+             qL0 = ZERO
+             qLC = ZERO
+             qLS = ZERO
+             qU0 = ZERO
+             qUC = ZERO
+             qUS = ZERO
+
+             call multipole_add(cosTheta, phiAngle, r, ONE, vol(i,j,k) / rmax**3, &
+                                qL0, qLC, qLS, qU0, qUC, qUS, lnum, 1, 0, index, .true.)
+
+             if ( doSymmetricAdd ) then
+
+                call multipole_symmetric_add(doSymmetricAddLo, doSymmetricAddHi, &
+                                             x, y, z, problo, probhi, &
+                                             ONE, vol(i,j,k) / rmax**3, &
+                                             qL0, qLC, qLS, qU0, qUC, qUS, &
+                                             lnum, 1, 0, index)
+
+             endif
+
+             do l = 0, lnum
+                basis(i,j,k,l) = qL0(l,0)
+             enddo
+
+             b = lnum + 1
+
+             do l = 1, lnum
+                do m = 1, l
+                   basis(i,j,k,b) = qLC(l,m,0)
+                   basis(i,j,k,b+ncs) = qLS(l,m,0)
+                   b = b + 1
+                enddo
+             enddo
+
+          enddo
+       enddo
+    enddo
+
+  end subroutine ca_compute_multipole_basis
+
+
+
+  subroutine ca_compute_multipole_moments_cached (lo,hi, &
+                                                  rho,r_lo,r_hi, &
+                                                  basis,b_lo,b_hi,nbasis, &
+                                                  q) &
+                                                  bind(C, name="ca_compute_multipole_moments_cached")
+
+    use amrex_constants_module, only: ZERO
+
+    use amrex_fort_module, only : rt => amrex_real
+    implicit none
+
+    integer , intent(in   ) :: lo(3),hi(3)
+    integer , intent(in   ) :: nbasis
+
+    integer , intent(in   ) :: r_lo(3), r_hi(3)
+    integer , intent(in   ) :: b_lo(3), b_hi(3)
+    real(rt), intent(in   ) :: rho(r_lo(1):r_hi(1),r_lo(2):r_hi(2),r_lo(3):r_hi(3))
+    real(rt), intent(in   ) :: basis(b_lo(1):b_hi(1),b_lo(2):b_hi(2),b_lo(3):b_hi(3),0:nbasis-1)
+    real(rt), intent(inout) :: q(0:nbasis-1)
+
+    integer          :: i, j, k, b
+    real(rt)         :: s
+
+    ! q = basis^T rho, one row of the tile at a time: the row of rho
+    ! stays in cache while we stream through the matching row of each
+    ! basis component, and the inner loop is a unit-stride dot product.
+
+    do k = lo(3), hi(3)
+       do j = lo(2), hi(2)
+          do b = 0, nbasis-1
+             s = ZERO
+             do i = lo(1), hi(1)
+                s = s + rho(i,j,k) * basis(i,j,k,b)
+             enddo
+             q(b) = q(b) + s
+          enddo
+       enddo
+    enddo
+
+  end subroutine ca_compute_multipole_moments_cached
+
+
+
+  subroutine ca_unpack_multipole_moments (q,nbasis,lnum, &
+                                          qL0,qLC,qLS,npts) &
+                                          bind(C, name="ca_unpack_multipole_moments")
+
+    use amrex_fort_module, only : rt => amrex_real
+    implicit none
+
+    integer , intent(in   ) :: nbasis, lnum, npts
+    real(rt), intent(in   ) :: q(0:nbasis-1)
+    real(rt), intent(inout) :: qL0(0:lnum,0:npts-1), qLC(0:lnum,0:lnum,0:npts-1), qLS(0:lnum,0:lnum,0:npts-1)
+
+    integer          :: l, m, b, ncs
+
+    ! Add the moments from ca_compute_multipole_moments_cached
+    ! into the outermost bin.
+
+    ncs = (lnum * (lnum+1)) / 2
+
+    do l = 0, lnum
+       qL0(l,npts-1) = qL0(l,npts-1) + q(l)
+    enddo
+
+    b = lnum + 1
+
+    do l = 1, lnum
+       do m = 1, l
+          qLC(l,m,npts-1) = qLC(l,m,npts-1) + q(b)
+          qLS(l,m,npts-1) = qLS(l,m,npts-1) + q(b+ncs)
+          b = b + 1
+       enddo
+    enddo
+
+  end subroutine ca_unpack_multipole_moments
+
+
+
   function factorial(n)
 
     use amrex_constants_module
@@ -776,7 +978,7 @@ contains
   subroutine multipole_symmetric_add(doSymmetricAddLo, doSymmetricAddHi, &
                                      x, y, z, problo, probhi, &
                                      rho, vol, &
-                                     qU0, qUC, qUS, qL0, qLC, qLS, &
+                                     qL0, qLC, qLS, qU0, qUC, qUS, &
                                      lnum, npts, nlo, index)
 
     use prob_params_module, only: center
@@ -888,7 +1090,7 @@ contains
                            qL0, qLC, qLS, qU0, qUC, qUS, &
                            lnum, npts, nlo, index, do_parity)
 
-    use amrex_constants_module, only: ONE
+    use amrex_constants_module, only: ZERO, ONE
 
     use amrex_fort_module, only : rt => amrex_real
     implicit none
@@ -905,10 +1107,13 @@ contains
 
     real(rt)         :: legPolyArr(0:lnum), assocLegPolyArr(0:lnum,0:lnum)
 
-    real(rt)         :: rho_r_L, rho_r_U
+    real(rt)         :: cosm(0:lnum), sinm(0:lnum), r_L(0:lnum), r_U(0:lnum)
 
     real(rt)         :: p0(0:lnum), pCS(0:lnum,0:lnum)
 
+    real(rt)         :: w0L(0:lnum), wCL(0:lnum,0:lnum), wSL(0:lnum,0:lnum)
+    real(rt)         :: w0U(0:lnum), wCU(0:lnum,0:lnum), wSU(0:lnum,0:lnum)
+
     call fill_legendre_arrays(legPolyArr, assocLegPolyArr, cosTheta, lnum)
 
     ! Absorb factorial terms into associated Legendre polynomials
@@ -925,35 +1130,90 @@ contains
        endif
     endif
 
-    do n = nlo, npts-1
+    call fill_trig_and_power_arrays(cosm, sinm, r_L, r_U, phiAngle, r, lnum)
 
-       do l = 0, lnum
+    ! The contribution of this zone to each moment does not depend on the
+    ! radial bin n, only on whether the zone is inside or outside it, so
+    ! we work out both sets of weights once and then add them to each bin.
 
-          rho_r_L = rho * (r ** dble( l  ))
-          rho_r_U = rho * (r ** dble(-l-1))
+    w0L = ZERO
+    wCL = ZERO
+    wSL = ZERO
+    w0U = ZERO
+    wCU = ZERO
+    wSU = ZERO
 
-          if (index .le. n) then
-             qL0(l,n) = qL0(l,n) + legPolyArr(l) * rho_r_L * vol * volumeFactor * p0(l)
-          else
-             qU0(l,n) = qU0(l,n) + legPolyArr(l) * rho_r_U * vol * volumeFactor * p0(l)
-          endif
+    do l = 0, lnum
 
-          do m = 1, l
+       w0L(l) = legPolyArr(l) * rho * r_L(l) * vol * volumeFactor * p0(l)
+       w0U(l) = legPolyArr(l) * rho * r_U(l) * vol * volumeFactor * p0(l)
 
-             if (index .le. n) then
-                qLC(l,m,n) = qLC(l,m,n) + assocLegPolyArr(l,m) * cos(m * phiAngle) * rho_r_L * vol * pCS(l,m)
-                qLS(l,m,n) = qLS(l,m,n) + assocLegPolyArr(l,m) * sin(m * phiAngle) * rho_r_L * vol * pCS(l,m)
-             else
-                qUC(l,m,n) = qUC(l,m,n) + assocLegPolyArr(l,m) * cos(m * phiAngle) * rho_r_U * vol * pCS(l,m)
-                qUS(l,m,n) = qUS(l,m,n) + assocLegPolyArr(l,m) * sin(m * phiAngle) * rho_r_U * vol * pCS(l,m)
-             endif
+       do m = 1, l
 
-          enddo
+          wCL(l,m) = assocLegPolyArr(l,m) * cosm(m) * rho * r_L(l) * vol * pCS(l,m)
+          wSL(l,m) = assocLegPolyArr(l,m) * sinm(m) * rho * r_L(l) * vol * pCS(l,m)
+          wCU(l,m) = assocLegPolyArr(l,m) * cosm(m) * rho * r_U(l) * vol * pCS(l,m)
+          wSU(l,m) = assocLegPolyArr(l,m) * sinm(m) * rho * r_U(l) * vol * pCS(l,m)
 
        enddo
 
     enddo
 
+    do n = nlo, npts-1
+
+       if (index .le. n) then
+          qL0(:,n)   = qL0(:,n)   + w0L
+          qLC(:,:,n) = qLC(:,:,n) + wCL
+          qLS(:,:,n) = qLS(:,:,n) + wSL
+       else
+          qU0(:,n)   = qU0(:,n)   + w0U
+          qUC(:,:,n) = qUC(:,:,n) + wCU
+          qUS(:,:,n) = qUS(:,:,n) + wSU
+       endif
+
+    enddo
+
   end subroutine multipole_add
 
+
+
+  subroutine fill_trig_and_power_arrays(cosm, sinm, r_L, r_U, phiAngle, r, lnum)
+
+    use amrex_constants_module, only: ZERO, ONE
+
+    use amrex_fort_module, only : rt => amrex_real
+    implicit none
+
+    integer,  intent(in   ) :: lnum
+    real(rt), intent(in   ) :: phiAngle, r
+    real(rt), intent(inout) :: cosm(0:lnum), sinm(0:lnum), r_L(0:lnum), r_U(0:lnum)
+
+    integer  :: l
+    real(rt) :: c, s
+
+    ! cos(m phi) and sin(m phi) from the angle addition formulas, and
+    ! r**l and r**(-l-1) by repeated multiplication, so we only need one
+    ! cos, sin and divide per zone instead of one per (l,m).
+
+    c = cos(phiAngle)
+    s = sin(phiAngle)
+
+    cosm(0) = ONE
+    sinm(0) = ZERO
+
+    r_L(0) = ONE
+    r_U(0) = ONE / r
+
+    do l = 1, lnum
+
+       cosm(l) = cosm(l-1) * c - sinm(l-1) * s
+       sinm(l) = sinm(l-1) * c + cosm(l-1) * s
+
+       r_L(l) = r_L(l-1) * r
+       r_U(l) = r_U(l-1) * r_U(0)
+
+    enddo
+
+  end subroutine fill_trig_and_power_arrays
+
 end module gravity_module
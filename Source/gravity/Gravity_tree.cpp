@@ -0,0 +1,216 @@
+#include "Gravity_tree.H"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+using namespace amrex;
+
+void
+GravityTree::clear ()
+{
+    px.clear();
+    py.clear();
+    pz.clear();
+    pm.clear();
+    nodes.clear();
+}
+
+void
+GravityTree::addMass (Real x, Real y, Real z, Real m)
+{
+    px.push_back(x);
+    py.push_back(y);
+    pz.push_back(z);
+    pm.push_back(m);
+}
+
+void
+GravityTree::build (int leaf_size)
+{
+    nodes.clear();
+
+    const int npts = pm.size();
+    if (npts == 0) return;
+
+    order.resize(npts);
+    std::iota(order.begin(), order.end(), 0);
+
+    nodes.reserve(2 * (npts / std::max(leaf_size, 1) + 1));
+
+    buildNode(0, npts, std::max(leaf_size, 1));
+
+    // Store the points in tree order so each leaf is contiguous.
+
+    std::vector<Real> tmp(npts);
+    for (std::vector<Real>* p : {&px, &py, &pz, &pm}) {
+        for (int i = 0; i < npts; ++i)
+            tmp[i] = (*p)[order[i]];
+        p->swap(tmp);
+    }
+
+    order.clear();
+}
+
+int
+GravityTree::buildNode (int first, int last, int leaf_size)
+{
+    const int inode = nodes.size();
+    nodes.push_back(Node());
+
+    Real lo[3] = { px[order[first]], py[order[first]], pz[order[first]] };
+    Real hi[3] = { lo[0], lo[1], lo[2] };
+
+    for (int k = first+1; k < last; ++k) {
+        const int i = order[k];
+        lo[0] = std::min(lo[0], px[i]); hi[0] = std::max(hi[0], px[i]);
+        lo[1] = std::min(lo[1], py[i]); hi[1] = std::max(hi[1], py[i]);
+        lo[2] = std::min(lo[2], pz[i]); hi[2] = std::max(hi[2], pz[i]);
+    }
+
+    int dir = 0;
+    for (int d = 1; d < 3; ++d)
+        if (hi[d] - lo[d] > hi[dir] - lo[dir]) dir = d;
+
+    {
+        Node& node = nodes[inode];
+        for (int d = 0; d < 3; ++d)
+            node.c[d] = 0.5 * (lo[d] + hi[d]);
+        node.size = hi[dir] - lo[dir];
+        node.first = first;
+        node.last = last;
+        node.left = -1;
+        node.right = -1;
+    }
+
+    const Real* c = nodes[inode].c;
+
+    Real M = 0.0;
+    Real D[3] = { 0.0 };
+    Real Q[6] = { 0.0 };
+
+    if (last - first <= leaf_size || nodes[inode].size == 0.0) {
+
+        // The moments straight from the points.
+
+        for (int k = first; k < last; ++k) {
+            const int i = order[k];
+            const Real m = pm[i];
+            const Real x = px[i] - c[0];
+            const Real y = py[i] - c[1];
+            const Real z = pz[i] - c[2];
+            const Real r2 = x*x + y*y + z*z;
+
+            M += m;
+            D[0] += m * x;
+            D[1] += m * y;
+            D[2] += m * z;
+            Q[0] += m * (3.0 * x * x - r2);
+            Q[1] += m * (3.0 * y * y - r2);
+            Q[2] += m * (3.0 * z * z - r2);
+            Q[3] += m * 3.0 * x * y;
+            Q[4] += m * 3.0 * x * z;
+            Q[5] += m * 3.0 * y * z;
+        }
+
+    } else {
+
+        const int mid = (first + last) / 2;
+        const std::vector<Real>& p = dir == 0 ? px : (dir == 1 ? py : pz);
+
+        std::nth_element(order.begin() + first, order.begin() + mid, order.begin() + last,
+                         [&p] (int a, int b) { return p[a] < p[b]; });
+
+        const int left  = buildNode(first, mid, leaf_size);
+        const int right = buildNode(mid, last, leaf_size);
+
+        nodes[inode].left  = left;
+        nodes[inode].right = right;
+
+        // Shift the children's moments to our center.
+
+        for (int child : {left, right}) {
+            const Node& ch = nodes[child];
+            const Real a[3] = { ch.c[0] - nodes[inode].c[0],
+                                ch.c[1] - nodes[inode].c[1],
+                                ch.c[2] - nodes[inode].c[2] };
+            const Real a2 = a[0]*a[0] + a[1]*a[1] + a[2]*a[2];
+            const Real Da = ch.D[0]*a[0] + ch.D[1]*a[1] + ch.D[2]*a[2];
+
+            M += ch.M;
+            for (int d = 0; d < 3; ++d)
+                D[d] += ch.D[d] + ch.M * a[d];
+
+            Q[0] += ch.Q[0] + 6.0 * ch.D[0] * a[0] - 2.0 * Da + ch.M * (3.0 * a[0] * a[0] - a2);
+            Q[1] += ch.Q[1] + 6.0 * ch.D[1] * a[1] - 2.0 * Da + ch.M * (3.0 * a[1] * a[1] - a2);
+            Q[2] += ch.Q[2] + 6.0 * ch.D[2] * a[2] - 2.0 * Da + ch.M * (3.0 * a[2] * a[2] - a2);
+            Q[3] += ch.Q[3] + 3.0 * (ch.D[0] * a[1] + ch.D[1] * a[0]) + ch.M * 3.0 * a[0] * a[1];
+            Q[4] += ch.Q[4] + 3.0 * (ch.D[0] * a[2] + ch.D[2] * a[0]) + ch.M * 3.0 * a[0] * a[2];
+            Q[5] += ch.Q[5] + 3.0 * (ch.D[1] * a[2] + ch.D[2] * a[1]) + ch.M * 3.0 * a[1] * a[2];
+        }
+
+    }
+
+    Node& node = nodes[inode];
+    node.M = M;
+    for (int d = 0; d < 3; ++d) node.D[d] = D[d];
+    for (int d = 0; d < 6; ++d) node.Q[d] = Q[d];
+
+    return inode;
+}
+
+Real
+GravityTree::potential (Real x, Real y, Real z, Real theta) const
+{
+    if (nodes.empty()) return 0.0;
+
+    const Real theta2 = theta * theta;
+
+    Real phi = 0.0;
+
+    int stack[128];
+    int nstack = 0;
+    stack[nstack++] = 0;
+
+    while (nstack > 0) {
+
+        const Node& node = nodes[stack[--nstack]];
+
+        const Real rx = x - node.c[0];
+        const Real ry = y - node.c[1];
+        const Real rz = z - node.c[2];
+        const Real r2 = rx*rx + ry*ry + rz*rz;
+
+        if (node.size * node.size < theta2 * r2) {
+
+            const Real rinv  = 1.0 / std::sqrt(r2);
+            const Real rinv2 = rinv * rinv;
+            const Real rinv3 = rinv * rinv2;
+            const Real rinv5 = rinv3 * rinv2;
+
+            const Real DR  = node.D[0] * rx + node.D[1] * ry + node.D[2] * rz;
+            const Real RQR = node.Q[0] * rx * rx + node.Q[1] * ry * ry + node.Q[2] * rz * rz +
+                             2.0 * (node.Q[3] * rx * ry + node.Q[4] * rx * rz + node.Q[5] * ry * rz);
+
+            phi += node.M * rinv + DR * rinv3 + 0.5 * RQR * rinv5;
+
+        } else if (node.left < 0) {
+
+            for (int i = node.first; i < node.last; ++i) {
+                const Real dx = x - px[i];
+                const Real dy = y - py[i];
+                const Real dz = z - pz[i];
+                phi += pm[i] / std::sqrt(dx*dx + dy*dy + dz*dz);
+            }
+
+        } else {
+
+            stack[nstack++] = node.right;
+            stack[nstack++] = node.left;
+
+        }
+
+    }
+
+    return phi;
+}
@@ -1,5 +1,8 @@
 #include "Castro.H"
 #include "Castro_F.H"
+#include "Castro_scratch.H"
+#include "Castro_kernel_stats.H"
+#include "Castro_tile_tuner.H"
 
 #ifdef RADIATION
 #include "Radiation.H"
@@ -14,6 +17,13 @@ Castro::construct_hydro_source(Real time, Real dt)
 
   BL_PROFILE("Castro::construct_hydro_source()");
 
+  KernelStats::Timer stats_timer(KernelStats::hydro, level, grids,
+                                 (2 + AMREX_SPACEDIM) * NUM_STATE + 2 * QVAR + NQAUX);
+
+  // While castro.hydro_tile_autotune is still trying tile shapes, this
+  // sets hydro_tile_size to the one to try.
+  TileTuner::Timer tile_timer(TileTuner::hydro, level, hydro_tile_size, grids.numPts());
+
   const Real strt_time = ParallelDescriptor::second();
 
   // this constructs the hydrodynamic source (essentially the flux
@@ -55,6 +65,27 @@ Castro::construct_hydro_source(Real time, Real dt)
 
     BL_PROFILE_VAR("Castro::advance_hydro_ca_umdrv()", CA_UMDRV);
 
+    // If the ghost zones of Sborder are still being exchanged, we do
+    // the hydro update in two passes: first the part of each tile that
+    // is far enough inside its grid not to need any ghost zones, and
+    // then, after finishing the exchange and the primitive variables
+    // in the ghost zones, the rest.
+
+    const int npass = sborder_exchange_pending ? 2 : 1;
+
+    for (int pass = 0; pass < npass; ++pass)
+    {
+
+      if (pass == 1) {
+          // The wait for the exchange isn't part of the hydro update.
+          tile_timer.pause();
+          finish_sborder_exchange();
+#ifndef RADIATION
+          cons_to_prim_ghost_zones(time);
+#endif
+          tile_timer.resume();
+      }
+
 #ifdef _OPENMP
 #ifdef RADIATION
 #pragma omp parallel reduction(max:nstep_fsp)
@@ -63,126 +94,166 @@ Castro::construct_hydro_source(Real time, Real dt)
 		     reduction(+:eden_lost,xang_lost,yang_lost,zang_lost)
 #endif
 #endif
-    {
+      {
 
-      FArrayBox flux[AMREX_SPACEDIM];
+        FArrayBox* flux[AMREX_SPACEDIM];
 #if (AMREX_SPACEDIM <= 2)
-      FArrayBox pradial(Box::TheUnitBox(),1);
+        FArrayBox* pradial = &ScratchArena::fab(ScratchArena::pradial, Box::TheUnitBox(), 1);
 #endif
 #ifdef RADIATION
-      FArrayBox rad_flux[AMREX_SPACEDIM];
+        FArrayBox* rad_flux[AMREX_SPACEDIM];
 #endif
 
-      int priv_nstep_fsp = -1;
+        int priv_nstep_fsp = -1;
 
-      int is_finest_level = (level == finest_level) ? 1 : 0;
+        int is_finest_level = (level == finest_level) ? 1 : 0;
 
-      for (MFIter mfi(S_new,hydro_tile_size); mfi.isValid(); ++mfi)
-      {
-	  const Box& bx    = mfi.tilebox();
+        for (MFIter mfi(S_new,hydro_tile_size); mfi.isValid(); ++mfi)
+        {
+	  const Box& tbx   = mfi.tilebox();
 
-	  const int* lo = bx.loVect();
-	  const int* hi = bx.hiVect();
+	  const Real cost_start = ParallelDescriptor::second();
 
-	  FArrayBox &statein  = Sborder[mfi];
-	  FArrayBox &stateout = S_new[mfi];
+	  // The parts of this tile to update in this pass.
 
-	  FArrayBox &source_out = hydro_source[mfi];
+	  BoxList boxes;
+
+	  if (npass == 1) {
+	    boxes.push_back(tbx);
+	  } else {
+	    const Box inner = tbx & amrex::grow(mfi.validbox(), -NUM_GROW);
+	    if (!inner.ok()) {
+	      if (pass == 1) boxes.push_back(tbx);
+	    } else if (pass == 0) {
+	      boxes.push_back(inner);
+	    } else {
+	      boxes = amrex::boxDiff(tbx, inner);
+	    }
+	  }
+
+	  for (const Box& bx : boxes) {
+
+	    const int* lo = bx.loVect();
+	    const int* hi = bx.hiVect();
+
+	    FArrayBox &statein  = Sborder[mfi];
+	    FArrayBox &stateout = S_new[mfi];
+
+	    FArrayBox &source_out = hydro_source[mfi];
 
 #ifdef RADIATION
-          FArrayBox &Er = Erborder[mfi];
-          FArrayBox &lam = lamborder[mfi];
-          FArrayBox &Erout = Er_new[mfi];
+	    FArrayBox &Er = Erborder[mfi];
+	    FArrayBox &lam = lamborder[mfi];
+	    FArrayBox &Erout = Er_new[mfi];
 #endif
 
-	  // Allocate fabs for fluxes
-	  for (int i = 0; i < AMREX_SPACEDIM ; i++)  {
-	    const Box& bxtmp = amrex::surroundingNodes(bx,i);
-	    flux[i].resize(bxtmp,NUM_STATE);
+	    // Allocate fabs for fluxes
+	    for (int i = 0; i < AMREX_SPACEDIM ; i++)  {
+	      const Box& bxtmp = amrex::surroundingNodes(bx,i);
+	      flux[i] = &ScratchArena::fab(ScratchArena::flux_x + i, bxtmp, NUM_STATE);
 #ifdef RADIATION
-	    rad_flux[i].resize(bxtmp,Radiation::nGroups);
+	      rad_flux[i] = &ScratchArena::fab(ScratchArena::rad_flux_x + i, bxtmp, Radiation::nGroups);
 #endif
-	  }
+	    }
 
 #if (AMREX_SPACEDIM <= 2)
-	  if (!Geometry::IsCartesian()) {
-	    pradial.resize(amrex::surroundingNodes(bx,0),1);
-	  }
+	    if (!Geometry::IsCartesian()) {
+	      pradial = &ScratchArena::fab(ScratchArena::pradial, amrex::surroundingNodes(bx,0), 1);
+	    }
 #endif
 
-	  ca_ctu_update
-	    (ARLIM_3D(lo), ARLIM_3D(hi), &is_finest_level, &time,
-	     ARLIM_3D(domain_lo), ARLIM_3D(domain_hi),
-	     BL_TO_FORTRAN_ANYD(statein), 
-	     BL_TO_FORTRAN_ANYD(stateout),
+	    ca_ctu_update
+	      (ARLIM_3D(lo), ARLIM_3D(hi), &is_finest_level, &time,
+	       ARLIM_3D(domain_lo), ARLIM_3D(domain_hi),
+	       BL_TO_FORTRAN_ANYD(statein), 
+	       BL_TO_FORTRAN_ANYD(stateout),
 #ifdef RADIATION
-	     BL_TO_FORTRAN_ANYD(Er), 
-	     BL_TO_FORTRAN_ANYD(Erout),
+	       BL_TO_FORTRAN_ANYD(Er), 
+	       BL_TO_FORTRAN_ANYD(Erout),
 #endif
-	     BL_TO_FORTRAN_ANYD(q[mfi]),
-	     BL_TO_FORTRAN_ANYD(qaux[mfi]),
-	     BL_TO_FORTRAN_ANYD(src_q[mfi]),
-	     BL_TO_FORTRAN_ANYD(source_out),
-	     ZFILL(dx), &dt,
-	     D_DECL(BL_TO_FORTRAN_ANYD(flux[0]),
-		    BL_TO_FORTRAN_ANYD(flux[1]),
-		    BL_TO_FORTRAN_ANYD(flux[2])),
+	       BL_TO_FORTRAN_ANYD(q[mfi]),
+	       BL_TO_FORTRAN_ANYD(qaux[mfi]),
+	       BL_TO_FORTRAN_ANYD(src_q[mfi]),
+	       BL_TO_FORTRAN_ANYD(source_out),
+	       ZFILL(dx), &dt,
+	       D_DECL(BL_TO_FORTRAN_ANYD(*flux[0]),
+		      BL_TO_FORTRAN_ANYD(*flux[1]),
+		      BL_TO_FORTRAN_ANYD(*flux[2])),
 #ifdef RADIATION
-	     D_DECL(BL_TO_FORTRAN_ANYD(rad_flux[0]),
-		    BL_TO_FORTRAN_ANYD(rad_flux[1]),
-		    BL_TO_FORTRAN_ANYD(rad_flux[2])),
+	       D_DECL(BL_TO_FORTRAN_ANYD(*rad_flux[0]),
+		      BL_TO_FORTRAN_ANYD(*rad_flux[1]),
+		      BL_TO_FORTRAN_ANYD(*rad_flux[2])),
 #endif
-	     D_DECL(BL_TO_FORTRAN_ANYD(area[0][mfi]),
-		    BL_TO_FORTRAN_ANYD(area[1][mfi]),
-		    BL_TO_FORTRAN_ANYD(area[2][mfi])),
+	       D_DECL(BL_TO_FORTRAN_ANYD(area[0][mfi]),
+		      BL_TO_FORTRAN_ANYD(area[1][mfi]),
+		      BL_TO_FORTRAN_ANYD(area[2][mfi])),
 #if (AMREX_SPACEDIM < 3)
-	     BL_TO_FORTRAN_ANYD(pradial),
-	     BL_TO_FORTRAN_ANYD(dLogArea[0][mfi]),
+	       BL_TO_FORTRAN_ANYD(*pradial),
+	       BL_TO_FORTRAN_ANYD(dLogArea[0][mfi]),
 #endif
-	     BL_TO_FORTRAN_ANYD(volume[mfi]),
-	     verbose,
+	       BL_TO_FORTRAN_ANYD(volume[mfi]),
+	       verbose,
 #ifdef RADIATION
-	     &priv_nstep_fsp,
+	       &priv_nstep_fsp,
 #endif
-	     mass_lost, xmom_lost, ymom_lost, zmom_lost,
-	     eden_lost, xang_lost, yang_lost, zang_lost);
+	       mass_lost, xmom_lost, ymom_lost, zmom_lost,
+	       eden_lost, xang_lost, yang_lost, zang_lost);
 
-	  // Store the fluxes from this advance.
-	  // For normal integration we want to add the fluxes from this advance
-	  // since we may be subcycling the timestep. But for SDC integration
-	  // we want to copy the fluxes since we expect that there will not be
-	  // subcycling and we only want the last iteration's fluxes.
+	    // Store the fluxes from this advance.
+	    // For normal integration we want to add the fluxes from this advance
+	    // since we may be subcycling the timestep. But for SDC integration
+	    // we want to copy the fluxes since we expect that there will not be
+	    // subcycling and we only want the last iteration's fluxes.
+
+	    // If the tile was done in parts, each face of it is stored from
+	    // just one of them: the part with the zone on its high side, or
+	    // for the faces on the high side of the tile, the zone below.
+
+	    for (int i = 0; i < AMREX_SPACEDIM ; i++) {
+	      Box nbx = amrex::surroundingNodes(bx,i);
+	      if (bx.bigEnd(i) < tbx.bigEnd(i)) nbx.growHi(i,-1);
+	      nbx &= mfi.nodaltilebox(i);
 
-	  for (int i = 0; i < AMREX_SPACEDIM ; i++) {
 #ifndef SDC
-	    (*fluxes    [i])[mfi].plus(    flux[i],mfi.nodaltilebox(i),0,0,NUM_STATE);
+	      (*fluxes    [i])[mfi].plus(    *flux[i],nbx,0,0,NUM_STATE);
 #ifdef RADIATION
-	    (*rad_fluxes[i])[mfi].plus(rad_flux[i],mfi.nodaltilebox(i),0,0,Radiation::nGroups);
+	      (*rad_fluxes[i])[mfi].plus(*rad_flux[i],nbx,0,0,Radiation::nGroups);
 #endif
 #else
-	    (*fluxes    [i])[mfi].copy(    flux[i],mfi.nodaltilebox(i),0,mfi.nodaltilebox(i),0,NUM_STATE);
+	      (*fluxes    [i])[mfi].copy(    *flux[i],nbx,0,nbx,0,NUM_STATE);
 #ifdef RADIATION
-	    (*rad_fluxes[i])[mfi].copy(rad_flux[i],mfi.nodaltilebox(i),0,mfi.nodaltilebox(i),0,Radiation::nGroups);
+	      (*rad_fluxes[i])[mfi].copy(*rad_flux[i],nbx,0,nbx,0,Radiation::nGroups);
 #endif	    
 #endif
-            (*mass_fluxes[i])[mfi].copy(flux[i],mfi.nodaltilebox(i),Density,mfi.nodaltilebox(i),0,1);
-	  }
+	      (*mass_fluxes[i])[mfi].copy(*flux[i],nbx,Density,nbx,0,1);
+	    }
 
 #if (AMREX_SPACEDIM <= 2)
-	  if (!Geometry::IsCartesian()) {
+	    if (!Geometry::IsCartesian()) {
+	      Box rbx = amrex::surroundingNodes(bx,0);
+	      if (bx.bigEnd(0) < tbx.bigEnd(0)) rbx.growHi(0,-1);
+	      rbx &= mfi.nodaltilebox(0);
+
 #ifndef SDC
-	    P_radial[mfi].plus(pradial,mfi.nodaltilebox(0),0,0,1);
+	      P_radial[mfi].plus(*pradial,rbx,0,0,1);
 #else
-	    P_radial[mfi].copy(pradial,mfi.nodaltilebox(0),0,mfi.nodaltilebox(0),0,1);
+	      P_radial[mfi].copy(*pradial,rbx,0,rbx,0,1);
 #endif
-	  }
+	    }
 #endif
-      } // MFIter loop
+
+	  } // loop over the parts of the tile
+
+	  add_cost(mfi, ParallelDescriptor::second() - cost_start);
+
+        } // MFIter loop
 
 #ifdef RADIATION
-      nstep_fsp = std::max(nstep_fsp, priv_nstep_fsp);
+        nstep_fsp = std::max(nstep_fsp, priv_nstep_fsp);
 #endif
-    }  // end of omp parallel region
+      }  // end of omp parallel region
+
+    } // pass loop
 
     BL_PROFILE_VAR_STOP(CA_UMDRV);
 
@@ -267,6 +338,291 @@ Castro::construct_hydro_source(Real time, Real dt)
     }
 
 }
+
+
+
+void
+Castro::construct_fused_hydro_source(Real time, Real dt)
+{
+
+  BL_PROFILE("Castro::construct_fused_hydro_source()");
+
+  // This includes the primitive variable conversion.
+  KernelStats::Timer stats_timer(KernelStats::hydro, level, grids,
+                                 (2 + AMREX_SPACEDIM) * NUM_STATE + NUM_STATE);
+
+  const Real strt_time = ParallelDescriptor::second();
+
+  // this is the same CTU update as construct_hydro_source, but the
+  // primitive variable conversion (cons_to_prim) and the CFL check
+  // are done tile by tile inside the same sweep.  q, qaux and src_q
+  // only exist for the current tile, so the data the CTU kernel works
+  // on stays in cache.  Since ctoprim and srctoprim are pointwise,
+  // the fluxes are identical to those of the unfused path.
+
+    if (verbose && ParallelDescriptor::IOProcessor())
+        std::cout << "... Entering fused hydro advance" << std::endl << std::endl;
+
+    hydro_source.setVal(0.0);
+
+    int finest_level = parent->finestLevel();
+
+    const Real *dx = geom.CellSize();
+
+    const int* domain_lo = geom.Domain().loVect();
+    const int* domain_hi = geom.Domain().hiVect();
+
+    MultiFab& S_new = get_new_data(State_Type);
+
+#ifdef SDC
+#ifdef REACTIONS
+    MultiFab& SDC_react_source = get_new_data(SDC_React_Type);
+#endif
+#endif
+
+    Real mass_lost       = 0.;
+    Real xmom_lost       = 0.;
+    Real ymom_lost       = 0.;
+    Real zmom_lost       = 0.;
+    Real eden_lost       = 0.;
+    Real xang_lost       = 0.;
+    Real yang_lost       = 0.;
+    Real zang_lost       = 0.;
+
+    Real courno = -1.0e+200;
+
+    // wall time spent in each stage, summed over threads
+    Real ctoprim_time = 0.0;
+    Real ctu_time     = 0.0;
+    Real store_time   = 0.0;
+
+    // zones converted to primitives and zones updated, to show how
+    // much of the conversion is redone in the ghost zones of each tile
+    Real ctoprim_zones = 0.0;
+    Real update_zones  = 0.0;
+
+    BL_PROFILE_VAR("Castro::advance_hydro_ca_umdrv()", CA_UMDRV);
+
+#ifdef _OPENMP
+#pragma omp parallel reduction(+:mass_lost,xmom_lost,ymom_lost,zmom_lost) \
+		     reduction(+:eden_lost,xang_lost,yang_lost,zang_lost) \
+		     reduction(+:ctoprim_time,ctu_time,store_time) \
+		     reduction(+:ctoprim_zones,update_zones) \
+		     reduction(max:courno)
+#endif
+    {
+
+      FArrayBox* flux[AMREX_SPACEDIM];
+#if (AMREX_SPACEDIM <= 2)
+      FArrayBox* pradial = &ScratchArena::fab(ScratchArena::pradial, Box::TheUnitBox(), 1);
+#endif
+
+      int is_finest_level = (level == finest_level) ? 1 : 0;
+
+      for (MFIter mfi(S_new, fused_tile_size); mfi.isValid(); ++mfi)
+      {
+	  const Box& bx  = mfi.tilebox();
+	  const Box& qbx = mfi.growntilebox(NUM_GROW);
+
+	  const int* lo = bx.loVect();
+	  const int* hi = bx.hiVect();
+
+	  FArrayBox &statein  = Sborder[mfi];
+	  FArrayBox &stateout = S_new[mfi];
+
+	  FArrayBox &source_out = hydro_source[mfi];
+
+	  Real t0 = ParallelDescriptor::second();
+
+	  // Tile-local primitive variables, only defined on the
+	  // tile grown by the hydro ghost zones.
+
+	  FArrayBox& q_tile     = ScratchArena::fab(ScratchArena::q_tile, qbx, NQ);
+	  FArrayBox& qaux_tile  = ScratchArena::fab(ScratchArena::qaux_tile, qbx, NQAUX);
+	  FArrayBox& src_q_tile = ScratchArena::fab(ScratchArena::src_q_tile, qbx, QVAR);
+
+	  ca_ctoprim(BL_TO_FORTRAN_BOX(qbx),
+		     BL_TO_FORTRAN_ANYD(statein),
+		     BL_TO_FORTRAN_ANYD(q_tile),
+		     BL_TO_FORTRAN_ANYD(qaux_tile));
+
+	  ca_srctoprim(BL_TO_FORTRAN_BOX(qbx),
+		       BL_TO_FORTRAN_ANYD(q_tile),
+		       BL_TO_FORTRAN_ANYD(qaux_tile),
+		       BL_TO_FORTRAN_ANYD(sources_for_hydro[mfi]),
+		       BL_TO_FORTRAN_ANYD(src_q_tile));
+
+#ifdef SDC
+#ifdef REACTIONS
+	  if (do_react)
+	      src_q_tile.plus(SDC_react_source[mfi],qbx,qbx,0,0,QVAR);
+#endif
+#endif
+
+	  ca_compute_cfl(BL_TO_FORTRAN_BOX(bx),
+			 BL_TO_FORTRAN_ANYD(q_tile),
+			 BL_TO_FORTRAN_ANYD(qaux_tile),
+			 dt, ZFILL(dx), &courno, print_fortran_warnings);
+
+	  Real t1 = ParallelDescriptor::second();
+
+	  // Allocate fabs for fluxes
+	  for (int i = 0; i < AMREX_SPACEDIM ; i++)  {
+	    const Box& bxtmp = amrex::surroundingNodes(bx,i);
+	    flux[i] = &ScratchArena::fab(ScratchArena::flux_x + i, bxtmp, NUM_STATE);
+	  }
+
+#if (AMREX_SPACEDIM <= 2)
+	  if (!Geometry::IsCartesian()) {
+	    pradial = &ScratchArena::fab(ScratchArena::pradial, amrex::surroundingNodes(bx,0), 1);
+	  }
+#endif
+
+	  ca_ctu_update
+	    (ARLIM_3D(lo), ARLIM_3D(hi), &is_finest_level, &time,
+	     ARLIM_3D(domain_lo), ARLIM_3D(domain_hi),
+	     BL_TO_FORTRAN_ANYD(statein),
+	     BL_TO_FORTRAN_ANYD(stateout),
+	     BL_TO_FORTRAN_ANYD(q_tile),
+	     BL_TO_FORTRAN_ANYD(qaux_tile),
+	     BL_TO_FORTRAN_ANYD(src_q_tile),
+	     BL_TO_FORTRAN_ANYD(source_out),
+	     ZFILL(dx), &dt,
+	     D_DECL(BL_TO_FORTRAN_ANYD(*flux[0]),
+		    BL_TO_FORTRAN_ANYD(*flux[1]),
+		    BL_TO_FORTRAN_ANYD(*flux[2])),
+	     D_DECL(BL_TO_FORTRAN_ANYD(area[0][mfi]),
+		    BL_TO_FORTRAN_ANYD(area[1][mfi]),
+		    BL_TO_FORTRAN_ANYD(area[2][mfi])),
+#if (AMREX_SPACEDIM < 3)
+	     BL_TO_FORTRAN_ANYD(*pradial),
+	     BL_TO_FORTRAN_ANYD(dLogArea[0][mfi]),
+#endif
+	     BL_TO_FORTRAN_ANYD(volume[mfi]),
+	     verbose,
+	     mass_lost, xmom_lost, ymom_lost, zmom_lost,
+	     eden_lost, xang_lost, yang_lost, zang_lost);
+
+	  Real t2 = ParallelDescriptor::second();
+
+	  // Store the fluxes from this advance, as in construct_hydro_source.
+
+	  for (int i = 0; i < AMREX_SPACEDIM ; i++) {
+#ifndef SDC
+	    (*fluxes    [i])[mfi].plus(    *flux[i],mfi.nodaltilebox(i),0,0,NUM_STATE);
+#else
+	    (*fluxes    [i])[mfi].copy(    *flux[i],mfi.nodaltilebox(i),0,mfi.nodaltilebox(i),0,NUM_STATE);
+#endif
+            (*mass_fluxes[i])[mfi].copy(*flux[i],mfi.nodaltilebox(i),Density,mfi.nodaltilebox(i),0,1);
+	  }
+
+#if (AMREX_SPACEDIM <= 2)
+	  if (!Geometry::IsCartesian()) {
+#ifndef SDC
+	    P_radial[mfi].plus(*pradial,mfi.nodaltilebox(0),0,0,1);
+#else
+	    P_radial[mfi].copy(*pradial,mfi.nodaltilebox(0),0,mfi.nodaltilebox(0),0,1);
+#endif
+	  }
+#endif
+
+	  Real t3 = ParallelDescriptor::second();
+
+	  ctoprim_time += t1 - t0;
+	  ctu_time     += t2 - t1;
+	  store_time   += t3 - t2;
+
+	  ctoprim_zones += qbx.numPts();
+	  update_zones  += bx.numPts();
+
+	  add_cost(mfi, t3 - t0);
+
+      } // MFIter loop
+
+    }  // end of omp parallel region
+
+    BL_PROFILE_VAR_STOP(CA_UMDRV);
+
+    // Check for CFL violations.  The caller discards the update if
+    // one was found.
+
+    ParallelDescriptor::ReduceRealMax(courno);
+
+    if (courno > 1.0) {
+        amrex::Print() << "WARNING -- EFFECTIVE CFL AT LEVEL " << level << " IS " << courno << std::endl << std::endl;
+
+        cfl_violation = 1;
+    }
+
+    // Flush Fortran output
+
+    if (verbose)
+      flush_output();
+
+    if (track_grid_losses)
+    {
+	material_lost_through_boundary_temp[0] += mass_lost;
+	material_lost_through_boundary_temp[1] += xmom_lost;
+	material_lost_through_boundary_temp[2] += ymom_lost;
+	material_lost_through_boundary_temp[3] += zmom_lost;
+	material_lost_through_boundary_temp[4] += eden_lost;
+	material_lost_through_boundary_temp[5] += xang_lost;
+	material_lost_through_boundary_temp[6] += yang_lost;
+	material_lost_through_boundary_temp[7] += zang_lost;
+    }
+
+    if (print_update_diagnostics)
+    {
+
+	bool local = true;
+	Vector<Real> hydro_update = evaluate_source_change(hydro_source, dt, local);
+
+#ifdef BL_LAZY
+	Lazy::QueueReduction( [=] () mutable {
+#endif
+	    ParallelDescriptor::ReduceRealSum(hydro_update.dataPtr(), hydro_update.size(), ParallelDescriptor::IOProcessorNumber());
+
+	    if (ParallelDescriptor::IOProcessor())
+		std::cout << std::endl << "  Contributions to the state from the hydro source:" << std::endl;
+
+	    print_source_change(hydro_update);
+
+#ifdef BL_LAZY
+	});
+#endif
+    }
+
+    if (verbose && ParallelDescriptor::IOProcessor())
+        std::cout << "... Leaving fused hydro advance" << std::endl << std::endl;
+
+    if (verbose > 0)
+    {
+        const int IOProc   = ParallelDescriptor::IOProcessorNumber();
+        Real      run_time = ParallelDescriptor::second() - strt_time;
+
+#ifdef BL_LAZY
+	Lazy::QueueReduction( [=] () mutable {
+#endif
+        Real stage_times[4] = {run_time, ctoprim_time, ctu_time, store_time};
+        ParallelDescriptor::ReduceRealMax(stage_times, 4, IOProc);
+
+        Real zones[2] = {ctoprim_zones, update_zones};
+        ParallelDescriptor::ReduceRealSum(zones, 2, IOProc);
+
+	if (ParallelDescriptor::IOProcessor()) {
+	  std::cout << "Castro::construct_fused_hydro_source() time = " << stage_times[0] << "\n";
+	  std::cout << "  stage times (summed over threads):" << "\n";
+	  std::cout << "    ctoprim + srctoprim + cfl     = " << stage_times[1] << "\n";
+	  std::cout << "    flatten/trace/riemann/consup  = " << stage_times[2] << "\n";
+	  std::cout << "    flux register store           = " << stage_times[3] << "\n";
+	  std::cout << "  zones converted per zone updated = " << zones[0] / zones[1] << "\n" << "\n";
+	}
+#ifdef BL_LAZY
+	});
+#endif
+    }
+
+}
 #endif
 
 
@@ -277,6 +633,9 @@ Castro::construct_mol_hydro_source(Real time, Real dt)
 
   BL_PROFILE("Castro::construct_mol_hydro_source()");
 
+  KernelStats::Timer stats_timer(KernelStats::mol_hydro, level, grids,
+                                 (2 + AMREX_SPACEDIM) * NUM_STATE + QVAR + NQAUX);
+
   // this constructs the hydrodynamic source (essentially the flux
   // divergence) using method of lines integration.  The output, as a
   // update to the state, is stored in the k_mol array of multifabs.
@@ -323,12 +682,12 @@ Castro::construct_mol_hydro_source(Real time, Real dt)
 #endif
   {
 
-    FArrayBox flux[AMREX_SPACEDIM];
+    FArrayBox* flux[AMREX_SPACEDIM];
 #if (AMREX_SPACEDIM <= 2)
-    FArrayBox pradial(Box::TheUnitBox(),1);
+    FArrayBox* pradial = &ScratchArena::fab(ScratchArena::pradial, Box::TheUnitBox(), 1);
 #endif
 #ifdef RADIATION
-    FArrayBox rad_flux[AMREX_SPACEDIM];
+    FArrayBox* rad_flux[AMREX_SPACEDIM];
 #endif
 
     int priv_nstep_fsp = -1;
@@ -340,6 +699,8 @@ Castro::construct_mol_hydro_source(Real time, Real dt)
 	const int* lo = bx.loVect();
 	const int* hi = bx.hiVect();
 
+	const Real cost_start = ParallelDescriptor::second();
+
 	FArrayBox &statein  = Sborder[mfi];
 	FArrayBox &stateout = S_new[mfi];
 
@@ -358,15 +719,15 @@ Castro::construct_mol_hydro_source(Real time, Real dt)
 	// All cate fabs for fluxes
 	for (int i = 0; i < AMREX_SPACEDIM ; i++)  {
 	  const Box& bxtmp = amrex::surroundingNodes(bx,i);
-	  flux[i].resize(bxtmp,NUM_STATE);
+	  flux[i] = &ScratchArena::fab(ScratchArena::flux_x + i, bxtmp, NUM_STATE);
 #ifdef RADIATION
-	  rad_flux[i].resize(bxtmp,Radiation::nGroups);
+	  rad_flux[i] = &ScratchArena::fab(ScratchArena::rad_flux_x + i, bxtmp, Radiation::nGroups);
 #endif
 	}
 
 #if (AMREX_SPACEDIM <= 2)
 	if (!Geometry::IsCartesian()) {
-	  pradial.resize(amrex::surroundingNodes(bx,0),1);
+	  pradial = &ScratchArena::fab(ScratchArena::pradial, amrex::surroundingNodes(bx,0), 1);
 	}
 #endif
         if (fourth_order) {
@@ -382,14 +743,14 @@ Castro::construct_mol_hydro_source(Real time, Real dt)
              BL_TO_FORTRAN_ANYD(source_out),
              BL_TO_FORTRAN_ANYD(source_hydro_only),
              ZFILL(dx), &dt,
-             D_DECL(BL_TO_FORTRAN_ANYD(flux[0]),
-                    BL_TO_FORTRAN_ANYD(flux[1]),
-                    BL_TO_FORTRAN_ANYD(flux[2])),
+             D_DECL(BL_TO_FORTRAN_ANYD(*flux[0]),
+                    BL_TO_FORTRAN_ANYD(*flux[1]),
+                    BL_TO_FORTRAN_ANYD(*flux[2])),
              D_DECL(BL_TO_FORTRAN_ANYD(area[0][mfi]),
                     BL_TO_FORTRAN_ANYD(area[1][mfi]),
                     BL_TO_FORTRAN_ANYD(area[2][mfi])),
 #if (AMREX_SPACEDIM < 3)
-             BL_TO_FORTRAN_ANYD(pradial),
+             BL_TO_FORTRAN_ANYD(*pradial),
              BL_TO_FORTRAN_ANYD(dLogArea[0][mfi]),
 #endif
              BL_TO_FORTRAN_ANYD(volume[mfi]),
@@ -407,14 +768,14 @@ Castro::construct_mol_hydro_source(Real time, Real dt)
              BL_TO_FORTRAN_ANYD(source_out),
              BL_TO_FORTRAN_ANYD(source_hydro_only),
              ZFILL(dx), &dt,
-             D_DECL(BL_TO_FORTRAN_ANYD(flux[0]),
-                    BL_TO_FORTRAN_ANYD(flux[1]),
-                    BL_TO_FORTRAN_ANYD(flux[2])),
+             D_DECL(BL_TO_FORTRAN_ANYD(*flux[0]),
+                    BL_TO_FORTRAN_ANYD(*flux[1]),
+                    BL_TO_FORTRAN_ANYD(*flux[2])),
              D_DECL(BL_TO_FORTRAN_ANYD(area[0][mfi]),
                     BL_TO_FORTRAN_ANYD(area[1][mfi]),
                     BL_TO_FORTRAN_ANYD(area[2][mfi])),
 #if (AMREX_SPACEDIM < 3)
-             BL_TO_FORTRAN_ANYD(pradial),
+             BL_TO_FORTRAN_ANYD(*pradial),
              BL_TO_FORTRAN_ANYD(dLogArea[0][mfi]),
 #endif
              BL_TO_FORTRAN_ANYD(volume[mfi]),
@@ -424,20 +785,23 @@ Castro::construct_mol_hydro_source(Real time, Real dt)
 	// Store the fluxes from this advance -- we weight them by the
 	// integrator weight for this stage
 	for (int i = 0; i < AMREX_SPACEDIM ; i++) {
-	  (*fluxes    [i])[mfi].saxpy(b_mol[mol_iteration], flux[i], 
+	  (*fluxes    [i])[mfi].saxpy(b_mol[mol_iteration], *flux[i], 
 				      mfi.nodaltilebox(i), mfi.nodaltilebox(i), 0, 0, NUM_STATE);
 #ifdef RADIATION
-	  (*rad_fluxes[i])[mfi].saxpy(b_mol[mol_iteration], rad_flux[i], 
+	  (*rad_fluxes[i])[mfi].saxpy(b_mol[mol_iteration], *rad_flux[i], 
 				      mfi.nodaltilebox(i), mfi.nodaltilebox(i), 0, 0, Radiation::nGroups);
 #endif
 	}
 
 #if (AMREX_SPACEDIM <= 2)
 	if (!Geometry::IsCartesian()) {
-	  P_radial[mfi].saxpy(b_mol[mol_iteration], pradial,
+	  P_radial[mfi].saxpy(b_mol[mol_iteration], *pradial,
                               mfi.nodaltilebox(0), mfi.nodaltilebox(0), 0, 0, 1);
 	}
 #endif
+
+	add_cost(mfi, ParallelDescriptor::second() - cost_start);
+
       } // MFIter loop
 
 #ifdef RADIATION
@@ -634,6 +998,10 @@ void
 Castro::cons_to_prim(const Real time)
 {
 
+    KernelStats::Timer stats_timer(KernelStats::ctoprim, level, grids, NUM_STATE + 2 * QVAR + NQAUX);
+
+    TileTuner::Timer tile_timer(TileTuner::ctoprim, level, ctoprim_tile_size, grids.numPts());
+
 #ifdef RADIATION
     AmrLevel::FillPatch(*this, Erborder, NUM_GROW, time, Rad_Type, 0, Radiation::nGroups);
 
@@ -651,9 +1019,12 @@ Castro::cons_to_prim(const Real time)
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
-    for (MFIter mfi(S_new, hydro_tile_size); mfi.isValid(); ++mfi) {
+    for (MFIter mfi(S_new, ctoprim_tile_size); mfi.isValid(); ++mfi) {
+
+        // If the ghost zones of Sborder are still being exchanged, only
+        // do the valid zones for now (see cons_to_prim_ghost_zones).
 
-        const Box& qbx = mfi.growntilebox(NUM_GROW);
+        const Box& qbx = sborder_exchange_pending ? mfi.tilebox() : mfi.growntilebox(NUM_GROW);
 
         // Convert the conservative state to the primitive variable state.
         // This fills both q and qaux.
@@ -699,6 +1070,49 @@ Castro::cons_to_prim(const Real time)
 }
 
 
+#if !defined(AMREX_USE_CUDA) && !defined(RADIATION)
+// The rest of cons_to_prim, for when it was called while the ghost zones
+// of Sborder were still being exchanged: the primitive variables and
+// sources in the ghost zones.
+
+void
+Castro::cons_to_prim_ghost_zones(const Real time)
+{
+
+    BL_PROFILE("Castro::cons_to_prim_ghost_zones()");
+
+    MultiFab& S_new = get_new_data(State_Type);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(S_new, ctoprim_tile_size); mfi.isValid(); ++mfi) {
+
+        const BoxList ghost_boxes = amrex::boxDiff(mfi.growntilebox(NUM_GROW), mfi.validbox());
+
+        for (const Box& qbx : ghost_boxes) {
+
+            ca_ctoprim(AMREX_INT_ANYD(qbx.loVect()), AMREX_INT_ANYD(qbx.hiVect()),
+                       BL_TO_FORTRAN_ANYD(Sborder[mfi]),
+                       BL_TO_FORTRAN_ANYD(q[mfi]),
+                       BL_TO_FORTRAN_ANYD(qaux[mfi]));
+
+            if (do_ctu) {
+              ca_srctoprim(BL_TO_FORTRAN_BOX(qbx),
+                           BL_TO_FORTRAN_ANYD(q[mfi]),
+                           BL_TO_FORTRAN_ANYD(qaux[mfi]),
+                           BL_TO_FORTRAN_ANYD(sources_for_hydro[mfi]),
+                           BL_TO_FORTRAN_ANYD(src_q[mfi]));
+            }
+
+        }
+
+    }
+
+}
+#endif
+
+
 #ifndef AMREX_USE_CUDA
 void
 Castro::cons_to_prim_fourth(const Real time)
@@ -726,8 +1140,7 @@ Castro::cons_to_prim_fourth(const Real time)
       // convert U_avg to U_cc -- this will use a Laplacian
       // operation and will result in U_cc defined only on
       // NUM_GROW-1 ghost cells at the end.
-      FArrayBox U_cc;
-      U_cc.resize(qbx, NUM_STATE);
+      FArrayBox& U_cc = ScratchArena::fab(ScratchArena::U_cc, qbx, NUM_STATE);
 
       ca_make_cell_center(BL_TO_FORTRAN_BOX(qbxm1),
                           BL_TO_FORTRAN_FAB(Sborder[mfi]),
@@ -735,8 +1148,7 @@ Castro::cons_to_prim_fourth(const Real time)
 
       // convert U_avg to q_bar -- this will be done on all NUM_GROW
       // ghost cells.
-      FArrayBox qaux_bar;
-      qaux_bar.resize(qbx, NQAUX);
+      FArrayBox& qaux_bar = ScratchArena::fab(ScratchArena::qaux_bar, qbx, NQAUX);
 
       ca_ctoprim(BL_TO_FORTRAN_BOX(qbx),
                  BL_TO_FORTRAN_ANYD(Sborder[mfi]),
@@ -801,7 +1213,7 @@ Castro::check_for_cfl_violation(const Real dt)
 #ifdef _OPENMP
 #pragma omp parallel reduction(max:courno)
 #endif
-    for (MFIter mfi(S_new, hydro_tile_size); mfi.isValid(); ++mfi) {
+    for (MFIter mfi(S_new, ctoprim_tile_size); mfi.isValid(); ++mfi) {
 
         const Box& bx = mfi.tilebox();
 
@@ -341,22 +341,41 @@ void Radiation::MGFLD_implicit_update(int level, int iteration, int ncycle)
 
       compute_coupling(coupT, coupY, kappa_p, Er_pi, jg);
 
+      // The coefficients of the linear systems depend on the opacities,
+      // which only change between outer iterations, and on the flux
+      // limiter. So unless the limiter was just updated, each group's
+      // system is the one we solved in the last inner iteration, and
+      // if we kept its solver we can skip the setup.
+
+      const bool coefs_changed = innerIteration == 1 ||
+	(limiter > 0 && innerIteration <= inner_update_limiter);
+
+      solver.resetTimers();
+
       for (int igroup=0; igroup<nGroups; ++igroup) {
 
 	set_current_group(igroup);
 
+	solver.levelSetGroup(level, igroup);
+
+	const bool new_coefs = coefs_changed || !solver.cachingGroupSolver(igroup);
+
 	// setup and solve linear system
 
-	// set boundary condition
-	solver.levelBndry(mgbd, igroup);
-	
-	solver.levelACoeffs(level, kappa_p, delta_t, c, igroup, ptc_tau);
+	if (new_coefs) {
+
+	  // set boundary condition
+	  solver.levelBndry(mgbd, igroup);
 
-	int lamcomp = (limiter==0) ? 0 : igroup;
-	solver.levelBCoeffs(level, lambda, kappa_r, igroup, c, lamcomp);
+	  solver.levelACoeffs(level, kappa_p, delta_t, c, igroup, ptc_tau);
+
+	  int lamcomp = (limiter==0) ? 0 : igroup;
+	  solver.levelBCoeffs(level, lambda, kappa_r, igroup, c, lamcomp);
+
+	  if (have_Sanchez_Pomraning) {
+	    solver.levelSPas(level, lambda, igroup, lo_bc, hi_bc);
+	  }
 
-	if (have_Sanchez_Pomraning) {
-	  solver.levelSPas(level, lambda, igroup, lo_bc, hi_bc);
 	}
 
 	{ // src and rhd block
@@ -369,7 +388,7 @@ void Radiation::MGFLD_implicit_update(int level, int iteration, int ncycle)
 			  delta_t, igroup, it, ptc_tau);
 
 	  // solve Er equation and put solution in Er_new(igroup)
-	  solver.levelSolve(level, Er_new, igroup, rhs, 0.01);
+	  solver.levelSolve(level, Er_new, igroup, rhs, 0.01, !new_coefs);
 	} // end src and rhs block
 
 	solver.levelFlux(level, Flux, Er_new, igroup);
@@ -379,19 +398,28 @@ void Radiation::MGFLD_implicit_update(int level, int iteration, int ncycle)
 	    solver.levelFluxFaceToCenter(level, Flux, *flxcc, icomp_flux+igroup);
 
       } // end loop over groups
-      
+
+      solver.levelSetGroup(level, -1);
+
       // Check for convergence *before* acceleration step:
       check_convergence_er(relative_in, absolute_in, error_er, Er_new, Er_pi,
       			   kappa_p, etaTz, etaYz, thetaTz, thetaYz,
 			   temp_new, Ye_new, grids, delta_t);
 
-      if (verbose >= 2 && ParallelDescriptor::IOProcessor()) {
-	int oldprec = std::cout.precision(3);
-        std::cout << "Outer = " << it << ", Inner = " << innerIteration
-             << ", inner err =  " << std::setw(8) << relative_in << " (rel),  " 
-	     << std::setw(8) << absolute_in << " (abs)" << std::endl;
-	//	     << std::setw(8) << error_er << " (impact)"<< std::endl;
-	std::cout.precision(oldprec);
+      if (verbose >= 2) {
+	Real solver_times[2] = {solver.setupTime(), solver.solveTime()};
+	ParallelDescriptor::ReduceRealMax(solver_times, 2, ParallelDescriptor::IOProcessorNumber());
+
+	if (ParallelDescriptor::IOProcessor()) {
+	  int oldprec = std::cout.precision(3);
+	  std::cout << "Outer = " << it << ", Inner = " << innerIteration
+	       << ", inner err =  " << std::setw(8) << relative_in << " (rel),  " 
+	       << std::setw(8) << absolute_in << " (abs)" << std::endl;
+	  //	     << std::setw(8) << error_er << " (impact)"<< std::endl;
+	  std::cout << "  linear solver setup time = " << solver_times[0]
+		    << ", solve time = " << solver_times[1] << std::endl;
+	  std::cout.precision(oldprec);
+	}
       }
 
       if (relative_in < 1.e-15) {
@@ -0,0 +1,418 @@
+#include <AMReX_ParmParse.H>
+#include <AMReX_LO_BCTYPES.H>
+
+#include "RadMLMG.H"
+#include "HypreABec.H"  // for the flux factor and face metrics
+#include "HABEC_F.H"
+
+#include <iostream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace amrex;
+
+RadMLMG::RadMLMG(const BoxArray& grids,
+                 const DistributionMapping& dmap,
+                 const Geometry& _geom)
+  : geom(_geom), alpha(1.0), beta(1.0), reltol(1.e-10), abstol(0.0),
+    bdp(NULL), bdcomp(0), crse_ratio(2), have_cf_flux(false), final_resnorm(0.0)
+{
+  ParmParse pp("radsolve");
+
+  verbose = 0; pp.query("mlmg_verbose", verbose);
+  agglomeration = 1; pp.query("mlmg_agglomeration", agglomeration);
+  consolidation = 1; pp.query("mlmg_consolidation", consolidation);
+
+  bho = 0; // as for HypreABec
+
+  for (int n = 0; n < BL_SPACEDIM; n++) {
+    dx[n] = geom.CellSize(n);
+  }
+
+  acoefs.define(grids, dmap, 1, 0);
+
+  for (int n = 0; n < BL_SPACEDIM; n++) {
+    BoxArray edge_boxes(grids);
+    edge_boxes.surroundingNodes(n);
+    bcoefs[n].define(edge_boxes, dmap, 1, 0);
+  }
+}
+
+void RadMLMG::setScalars(Real Alpha, Real Beta)
+{
+  alpha = Alpha;
+  beta  = Beta;
+}
+
+void RadMLMG::aCoefficients(const MultiFab &a)
+{
+  BL_ASSERT( a.ok() );
+  BL_ASSERT( a.boxArray() == acoefs.boxArray() );
+  MultiFab::Copy(acoefs, a, 0, 0, 1, 0);
+}
+
+void RadMLMG::bCoefficients(const MultiFab &b, int dir)
+{
+  BL_ASSERT( b.ok() );
+  BL_ASSERT( b.boxArray() == bcoefs[dir].boxArray() );
+  MultiFab::Copy(bcoefs[dir], b, 0, 0, 1, 0);
+}
+
+void RadMLMG::SPalpha(const MultiFab& a)
+{
+  BL_ASSERT( a.ok() );
+  if (SPa == 0) {
+    const BoxArray& grids = a.boxArray();
+    const DistributionMapping& dmap = a.DistributionMap();
+    SPa.reset(new MultiFab(grids,dmap,1,0));
+  }
+  MultiFab::Copy(*SPa, a, 0, 0, 1, 0);
+}
+
+void RadMLMG::setCoarseData(const MultiFab& crse, int comp, int ratio)
+{
+  if (crse_data == 0 || crse_data->boxArray() != crse.boxArray()) {
+    crse_data.reset(new MultiFab(crse.boxArray(), crse.DistributionMap(), 1, 0));
+  }
+  MultiFab::Copy(*crse_data, crse, comp, 0, 1, 0);
+  crse_ratio = ratio;
+}
+
+void RadMLMG::setupSolver(Real _reltol, Real _abstol, int maxiter)
+{
+  BL_PROFILE("RadMLMG::setupSolver");
+
+  if (alpha == 0.0) {
+    amrex::Error("RadMLMG: the boundary conditions are put in the a coefficients, so alpha must not be zero");
+  }
+
+  reltol = _reltol;
+  abstol = _abstol;
+
+  const BoxArray& grids = acoefs.boxArray();
+  const DistributionMapping& dmap = acoefs.DistributionMap();
+
+  const NGBndry& bd = getBndry();
+  const Box& domain = bd.getDomain();
+
+  // The a coefficients with the domain boundary conditions added.
+  // hbmat3 gives the matrix diagonal at the boundary for the actual
+  // boundary condition, and for a homogeneous Neumann boundary, which
+  // is what MLMG will see, so the difference is what we need to add.
+
+  MultiFab acoefs_bc(grids, dmap, 1, 0);
+  MultiFab::Copy(acoefs_bc, acoefs, 0, 0, 1, 0);
+
+  const int size = BL_SPACEDIM + 1;
+  const int diag = BL_SPACEDIM;
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+  {
+    Vector<Real> r;
+    Real foo=1.e200;
+    FArrayBox matfab, mat0fab;
+
+    for (MFIter ai(acoefs); ai.isValid(); ++ai) {
+      int i = ai.index();
+      const Box &reg = grids[i];
+
+      matfab.resize(reg,size);
+      matfab.setVal(0.0);
+      mat0fab.resize(reg,size);
+      mat0fab.setVal(0.0);
+
+      for (OrientationIter oitr; oitr; oitr++) {
+        if (reg[oitr()] != domain[oitr()]) continue;
+
+        int cdir(oitr());
+        int idim = oitr().coordDir();
+        const RadBoundCond &bct = bd.bndryConds(oitr())[i];
+        const Real      &bcl = bd.bndryLocs(oitr())[i];
+        const Mask      &msk = bd.bndryMasks(oitr(),i);
+        const int *tfp = NULL;
+        int bctype = bct;
+        if (bd.mixedBndry(oitr())) {
+          const BaseFab<int> &tf = *(bd.bndryTypes(oitr())[i]);
+          tfp = tf.dataPtr();
+          bctype = -1;
+        }
+        const Box &fsb = bd.bndryValues(oitr())[ai].box();
+        Real* pSPa;
+        Box SPabox;
+        if (SPa != 0) {
+          pSPa = (*SPa)[ai].dataPtr();
+          SPabox = (*SPa)[ai].box();
+        }
+        else {
+          pSPa = &foo;
+          SPabox = Box(IntVect::TheZeroVector(),IntVect::TheZeroVector());
+        }
+        HypreABec::getFaceMetric(r, reg, oitr(), geom);
+        hbmat3(matfab.dataPtr(), ARLIM(reg.loVect()), ARLIM(reg.hiVect()),
+               cdir, bctype, tfp, bcl,
+               ARLIM(fsb.loVect()), ARLIM(fsb.hiVect()),
+               BL_TO_FORTRAN(msk),
+               BL_TO_FORTRAN(bcoefs[idim][ai]),
+               beta, dx, HypreABec::fluxFactor(), r.dataPtr(),
+               pSPa, ARLIM(SPabox.loVect()), ARLIM(SPabox.hiVect()));
+        hbmat3(mat0fab.dataPtr(), ARLIM(reg.loVect()), ARLIM(reg.hiVect()),
+               cdir, LO_NEUMANN, NULL, bcl,
+               ARLIM(fsb.loVect()), ARLIM(fsb.hiVect()),
+               BL_TO_FORTRAN(msk),
+               BL_TO_FORTRAN(bcoefs[idim][ai]),
+               beta, dx, HypreABec::fluxFactor(), r.dataPtr(),
+               pSPa, ARLIM(SPabox.loVect()), ARLIM(SPabox.hiVect()));
+      }
+
+      matfab.minus(mat0fab, diag, diag, 1);
+      acoefs_bc[ai].saxpy(1.0 / alpha, matfab, reg, reg, diag, 0, 1);
+    }
+  }
+
+  LPInfo info;
+  info.setMetricTerm(false);
+  info.setAgglomeration(agglomeration);
+  info.setConsolidation(consolidation);
+
+  mlabec.reset(new MLABecLaplacian({geom}, {grids}, {dmap}, info));
+
+  mlabec->setMaxOrder(2);
+
+  std::array<MLLinOp::BCType,AMREX_SPACEDIM> lobc, hibc;
+  for (int idim = 0; idim < BL_SPACEDIM; idim++) {
+    if (geom.isPeriodic(idim)) {
+      lobc[idim] = MLLinOp::BCType::Periodic;
+      hibc[idim] = MLLinOp::BCType::Periodic;
+    }
+    else {
+      lobc[idim] = MLLinOp::BCType::Neumann;
+      hibc[idim] = MLLinOp::BCType::Neumann;
+    }
+  }
+  mlabec->setDomainBC(lobc, hibc);
+
+  if (crse_data) {
+    mlabec->setCoarseFineBC(crse_data.get(), crse_ratio);
+  }
+
+  mlabec->setScalars(alpha, beta);
+  mlabec->setACoeffs(0, acoefs_bc);
+  mlabec->setBCoeffs(0, {AMREX_D_DECL(&bcoefs[0], &bcoefs[1], &bcoefs[2])});
+
+  mlmg.reset(new MLMG(*mlabec));
+  mlmg->setMaxIter(maxiter);
+  mlmg->setVerbose(verbose);
+}
+
+void RadMLMG::clearSolver()
+{
+  mlmg.reset();
+  mlabec.reset();
+}
+
+void RadMLMG::solve(MultiFab& dest, int icomp, MultiFab& rhs, BC_Mode inhom)
+{
+  BL_PROFILE("RadMLMG::solve");
+
+  const BoxArray& grids = acoefs.boxArray();
+  const DistributionMapping& dmap = acoefs.DistributionMap();
+
+  // The right hand side with the domain boundary values added, as in
+  // HypreABec::solve.
+
+  MultiFab rhs_bc(grids, dmap, 1, 0);
+  MultiFab::Copy(rhs_bc, rhs, 0, 0, 1, 0);
+
+  if (inhom) {
+    const NGBndry& bd = getBndry();
+    const Box& domain = bd.getDomain();
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+      Vector<Real> r;
+      FArrayBox vecfab;
+
+      for (MFIter ri(rhs_bc); ri.isValid(); ++ri) {
+        int i = ri.index();
+        const Box &reg = grids[i];
+
+        vecfab.resize(reg);
+        vecfab.setVal(0.0);
+
+        for (OrientationIter oitr; oitr; oitr++) {
+          if (reg[oitr()] != domain[oitr()]) continue;
+
+          int cdir(oitr());
+          int idim = oitr().coordDir();
+          const RadBoundCond &bct = bd.bndryConds(oitr())[i];
+          const Real      &bcl = bd.bndryLocs(oitr())[i];
+          const FArrayBox &fs  = bd.bndryValues(oitr())[ri];
+          const Mask      &msk = bd.bndryMasks(oitr(),i);
+          const int *tfp = NULL;
+          int bctype = bct;
+          if (bd.mixedBndry(oitr())) {
+            const BaseFab<int> &tf = *(bd.bndryTypes(oitr())[i]);
+            tfp = tf.dataPtr();
+            bctype = -1;
+          }
+          HypreABec::getFaceMetric(r, reg, oitr(), geom);
+          hbvec3(vecfab.dataPtr(), ARLIM(reg.loVect()), ARLIM(reg.hiVect()),
+                 cdir, bctype, tfp, bho, bcl,
+                 BL_TO_FORTRAN_N(fs, bdcomp),
+                 BL_TO_FORTRAN(msk),
+                 BL_TO_FORTRAN(bcoefs[idim][ri]),
+                 beta, dx, r.dataPtr());
+        }
+
+        rhs_bc[ri].plus(vecfab, reg, reg, 0, 0, 1);
+      }
+    }
+  }
+
+  // MLMG wants a ghost cell for the solution, so we can't solve in
+  // place in general.
+
+  MultiFab sol(grids, dmap, 1, 1);
+  sol.setVal(0.0);
+  MultiFab::Copy(sol, dest, icomp, 0, 1, 0);
+
+  mlabec->setLevelBC(0, &sol);
+
+  final_resnorm = mlmg->solve({&sol}, {&rhs_bc}, reltol, abstol);
+
+  MultiFab::Copy(dest, sol, 0, icomp, 1, 0);
+
+  // Keep the fluxes at the coarse-fine boundaries as MLMG computed
+  // them, for boundaryFlux.
+
+  have_cf_flux = false;
+  if (crse_data) {
+    for (int n = 0; n < BL_SPACEDIM; n++) {
+      if (cf_flux[n].boxArray() != bcoefs[n].boxArray()) {
+        cf_flux[n].define(bcoefs[n].boxArray(), dmap, 1, 0);
+      }
+    }
+    Vector<std::array<MultiFab*,AMREX_SPACEDIM> > flux(1);
+    flux[0] = {AMREX_D_DECL(&cf_flux[0], &cf_flux[1], &cf_flux[2])};
+    mlmg->getFluxes(flux);
+    have_cf_flux = true;
+  }
+
+  if (verbose >= 1 && ParallelDescriptor::IOProcessor()) {
+    int oldprec = std::cout.precision(20);
+    std::cout << mlmg->getNumIters() << " MLMG Iterations, Residual "
+              << final_resnorm << std::endl;
+    std::cout.precision(oldprec);
+  }
+}
+
+void RadMLMG::boundaryFlux(MultiFab* Flux, MultiFab& Soln, int icomp,
+                           BC_Mode inhom)
+{
+    BL_PROFILE("RadMLMG::boundaryFlux");
+
+    // The same as HypreABec::boundaryFlux.
+
+    const BoxArray &grids = Soln.boxArray();
+
+    const NGBndry& bd = getBndry();
+    const Box& domain = bd.getDomain();
+
+    // Away from the domain boundary, use the fluxes MLMG computed in
+    // the solve, which come from its own interpolation of the coarse
+    // data.  With radsolve.mlmg_verbose, report how far the HypreABec
+    // stencil on the NGBndry values is from them.
+
+    const bool use_cf_flux = have_cf_flux && inhom;
+    Real cf_diff = 0.0, cf_max = 0.0;
+
+#ifdef _OPENMP
+#pragma omp parallel reduction(max:cf_diff,cf_max)
+#endif
+    {
+	Vector<Real> r;
+	Real foo=1.e200;
+	FArrayBox dfab;
+
+	for (MFIter si(Soln); si.isValid(); ++si) {
+	    int i = si.index();
+	    const Box &reg = grids[i];
+	    for (OrientationIter oitr; oitr; oitr++) {
+		int cdir(oitr());
+		int idim = oitr().coordDir();
+		const RadBoundCond &bct = bd.bndryConds(oitr())[i];
+		const Real      &bcl = bd.bndryLocs(oitr())[i];
+		const FArrayBox       &fs  = bd.bndryValues(oitr())[si];
+		const Mask      &msk = bd.bndryMasks(oitr(),i);
+
+		if (reg[oitr()] == domain[oitr()]) {
+		    const int *tfp = NULL;
+		    int bctype = bct;
+		    if (bd.mixedBndry(oitr())) {
+			const BaseFab<int> &tf = *(bd.bndryTypes(oitr())[i]);
+			tfp = tf.dataPtr();
+			bctype = -1;
+		    }
+		    Real* pSPa;
+		    Box SPabox;
+		    if (SPa != 0) {
+			pSPa = (*SPa)[si].dataPtr();
+			SPabox = (*SPa)[si].box();
+		    }
+		    else {
+			pSPa = &foo;
+			SPabox = Box(IntVect::TheZeroVector(),IntVect::TheZeroVector());
+		    }
+		    HypreABec::getFaceMetric(r, reg, oitr(), geom);
+		    hbflx3(BL_TO_FORTRAN(Flux[idim][si]),
+			   BL_TO_FORTRAN_N(Soln[si], icomp),
+			   ARLIM(reg.loVect()), ARLIM(reg.hiVect()),
+			   cdir, bctype, tfp, bho, bcl,
+			   BL_TO_FORTRAN_N(fs, bdcomp),
+			   BL_TO_FORTRAN(msk),
+			   BL_TO_FORTRAN(bcoefs[idim][si]),
+			   beta, dx, HypreABec::fluxFactor(), r.dataPtr(), inhom,
+			   pSPa, ARLIM(SPabox.loVect()), ARLIM(SPabox.hiVect()));
+		}
+		else {
+		    hbflx(BL_TO_FORTRAN(Flux[idim][si]),
+			  BL_TO_FORTRAN_N(Soln[si], icomp),
+			  ARLIM(reg.loVect()), ARLIM(reg.hiVect()),
+			  cdir, bct, bho, bcl,
+			  BL_TO_FORTRAN_N(fs, bdcomp),
+			  BL_TO_FORTRAN(msk),
+			  BL_TO_FORTRAN(bcoefs[idim][si]),
+			  beta, dx, inhom);
+
+		    if (use_cf_flux) {
+			const Box fbx = amrex::bdryNode(reg, oitr());
+			const FArrayBox& mf = cf_flux[idim][si];
+			if (verbose >= 1) {
+			    dfab.resize(fbx, 1);
+			    dfab.copy(Flux[idim][si], fbx, 0, fbx, 0, 1);
+			    dfab.minus(mf, fbx, fbx, 0, 0, 1);
+			    cf_diff = std::max(cf_diff, dfab.norm(fbx, 0, 0, 1));
+			    cf_max = std::max(cf_max, mf.norm(fbx, 0, 0, 1));
+			}
+			Flux[idim][si].copy(mf, fbx, 0, fbx, 0, 1);
+		    }
+		}
+	    }
+	}
+    }
+
+    if (use_cf_flux && verbose >= 1) {
+	ParallelDescriptor::ReduceRealMax(cf_diff);
+	ParallelDescriptor::ReduceRealMax(cf_max);
+	if (ParallelDescriptor::IOProcessor()) {
+	    std::cout << "RadMLMG: max coarse-fine flux difference from the HypreABec stencil = "
+		      << cf_diff << " (max flux " << cf_max << ")" << std::endl;
+	}
+    }
+}
@@ -23,7 +23,9 @@ using namespace amrex;
 Vector<Real> RadSolve::absres(0);
 
 RadSolve::RadSolve(Amr* Parent) : parent(Parent),
-  hd(NULL), hm(NULL)
+  hd(NULL), hm(NULL), hmg(NULL),
+  current_group(-1), level_hd(NULL), level_hm(NULL), level_hmg(NULL),
+  setup_time(0.0), solve_time(0.0)
 {
   ParmParse pp("radsolve");
 
@@ -58,6 +60,13 @@ RadSolve::RadSolve(Amr* Parent) : parent(Parent),
     }
   }
 
+  use_mlmg = 0;
+  pp.query("use_mlmg", use_mlmg);
+
+  if (use_mlmg && use_hypre_nonsymmetric_terms) {
+    amrex::Error("radsolve.use_mlmg can't be used with the nonsymmetric terms (Er_Lorentz_term or accelerate = 2).");
+  }
+
   ParmParse ppr("radiation");
 
   reltol     = 1.0e-10;   pp.query("reltol",  reltol);
@@ -77,6 +86,9 @@ RadSolve::RadSolve(Amr* Parent) : parent(Parent),
 
   verbose = 0; pp.query("v", verbose); pp.query("verbose", verbose);
 
+  cache_group_solvers = 0; pp.query("cache_group_solvers", cache_group_solvers);
+  cache_group_solvers_max = 0; pp.query("cache_group_solvers_max", cache_group_solvers_max);
+
   {
     // Putting this here is a kludge, but I make the factors static and
     // enter them here for both kinds of solvers so that any solver
@@ -103,7 +115,10 @@ RadSolve::RadSolve(Amr* Parent) : parent(Parent),
     std::cout << "radsolve.abstol                 = " << abstol << std::endl;
     std::cout << "radsolve.use_hypre_nonsymmetric_terms = "
          << use_hypre_nonsymmetric_terms << std::endl;
+    std::cout << "radsolve.use_mlmg               = " << use_mlmg << std::endl;
     std::cout << "radsolve.verbose                = " << verbose << std::endl;
+    std::cout << "radsolve.cache_group_solvers    = " << cache_group_solvers << std::endl;
+    std::cout << "radsolve.cache_group_solvers_max = " << cache_group_solvers_max << std::endl;
   }
 
   // Static initialization:
@@ -115,30 +130,76 @@ RadSolve::RadSolve(Amr* Parent) : parent(Parent),
 void RadSolve::levelInit(int level)
 {
   BL_PROFILE("RadSolve::levelInit");
+
+  buildSolver(level, hd, hm, hmg);
+
+  if (hm && use_hypre_nonsymmetric_terms) {
+    HypreExtMultiABec *hem = (HypreExtMultiABec*)hm;
+    cMulti  = hem->cMultiplier();
+    d1Multi = hem->d1Multiplier();
+    d2Multi = hem->d2Multiplier();
+  }
+}
+
+void RadSolve::buildSolver(int level, HypreABec*& d, HypreMultiABec*& m, RadMLMG*& mg)
+{
   const BoxArray& grids = parent->boxArray(level);
   const DistributionMapping& dmap = parent->DistributionMap(level);
 //  const Real *dx = parent->Geom(level).CellSize();
 
-  if (level_solver_flag < 100) {
-      hd = new HypreABec(grids, dmap, parent->Geom(level), level_solver_flag);
+  if (use_mlmg) {
+      mg = new RadMLMG(grids, dmap, parent->Geom(level));
+  }
+  else if (level_solver_flag < 100) {
+      d = new HypreABec(grids, dmap, parent->Geom(level), level_solver_flag);
   }
   else {
       if (use_hypre_nonsymmetric_terms == 0) {
-	  hm = new HypreMultiABec(level, level, level_solver_flag);
+	  m = new HypreMultiABec(level, level, level_solver_flag);
       }
       else {
-	  hm = new HypreExtMultiABec(level, level, level_solver_flag);
-	  HypreExtMultiABec *hem = (HypreExtMultiABec*)hm;
-	  cMulti  = hem->cMultiplier();
-	  d1Multi = hem->d1Multiplier();
-	  d2Multi = hem->d2Multiplier();
+	  m = new HypreExtMultiABec(level, level, level_solver_flag);
       }
-      hm->addLevel(level, parent->Geom(level), grids, dmap,
-                   IntVect::TheUnitVector());
-      hm->buildMatrixStructure();
+      m->addLevel(level, parent->Geom(level), grids, dmap,
+                  IntVect::TheUnitVector());
+      m->buildMatrixStructure();
   }
 }
 
+void RadSolve::levelSetGroup(int level, int igroup)
+{
+  if (!cache_group_solvers) return;
+
+  if (current_group < 0) {
+    level_hd = hd;
+    level_hm = hm;
+    level_hmg = hmg;
+  }
+
+  if (igroup < 0 || !cachingGroupSolver(igroup)) {
+    hd = level_hd;
+    hm = level_hm;
+    hmg = level_hmg;
+    current_group = -1;
+    return;
+  }
+
+  if (group_solvers.size() <= igroup) {
+    group_solvers.resize(igroup + 1);
+  }
+
+  GroupSolver& g = group_solvers[igroup];
+
+  if (g.hd == NULL && g.hm == NULL && g.hmg == NULL) {
+    buildSolver(level, g.hd, g.hm, g.hmg);
+  }
+
+  hd = g.hd;
+  hm = g.hm;
+  hmg = g.hmg;
+  current_group = igroup;
+}
+
 void RadSolve::levelBndry(RadBndry& bd)
 {
   BL_PROFILE("RadSolve::levelBndry");
@@ -149,6 +210,9 @@ void RadSolve::levelBndry(RadBndry& bd)
   else if (hm) {
     hm->setBndry(hm->crseLevel(), bd);
   }
+  else if (hmg) {
+    hmg->setBndry(bd);
+  }
 }
 
 // update multigroup version
@@ -162,10 +226,20 @@ void RadSolve::levelBndry(MGRadBndry& mgbd, const int comp)
   else if (hm) {
     hm->setBndry(hm->crseLevel(), mgbd, comp);
   }
+  else if (hmg) {
+    hmg->setBndry(mgbd, comp);
+  }
 }
 
 void RadSolve::levelClear()
 {
+  if (current_group >= 0) {
+    hd = level_hd;
+    hm = level_hm;
+    hmg = level_hmg;
+    current_group = -1;
+  }
+
   if (hd) {
     delete hd;
     hd = NULL;
@@ -174,6 +248,26 @@ void RadSolve::levelClear()
     delete hm;
     hm = NULL;
   }
+  else if (hmg) {
+    delete hmg;
+    hmg = NULL;
+  }
+
+  for (GroupSolver& g : group_solvers) {
+    if (g.hd) {
+      if (g.ready) g.hd->clearSolver();
+      delete g.hd;
+    }
+    else if (g.hm) {
+      if (g.ready) g.hm->clearSolver();
+      delete g.hm;
+    }
+    else if (g.hmg) {
+      if (g.ready) g.hmg->clearSolver();
+      delete g.hmg;
+    }
+  }
+  group_solvers.clear();
 }
 
 void RadSolve::cellCenteredApplyMetrics(int level, MultiFab& cc)
@@ -208,6 +302,9 @@ void RadSolve::setLevelACoeffs(int level, const MultiFab& acoefs)
     else if (hm) {
 	hm->aCoefficients(level, acoefs);
     }
+    else if (hmg) {
+	hmg->aCoefficients(acoefs);
+    }
 }
 
 void RadSolve::setLevelBCoeffs(int level, const MultiFab& bcoefs, int dir)
@@ -218,6 +315,9 @@ void RadSolve::setLevelBCoeffs(int level, const MultiFab& bcoefs, int dir)
     else if (hm) {
 	hm->bCoefficients(level, bcoefs, dir);
     }
+    else if (hmg) {
+	hmg->bCoefficients(bcoefs, dir);
+    }
 }
 
 void RadSolve::setLevelCCoeffs(int level, const MultiFab& ccoefs, int dir)
@@ -269,6 +369,9 @@ void RadSolve::levelACoeffs(int level,
   else if (hm) {
     hm->aCoefficients(level, acoefs);
   }
+  else if (hmg) {
+    hmg->aCoefficients(acoefs);
+  }
 }
 
 void RadSolve::levelSPas(int level, Tuple<MultiFab, BL_SPACEDIM>& lambda, int igroup, 
@@ -318,6 +421,9 @@ void RadSolve::levelSPas(int level, Tuple<MultiFab, BL_SPACEDIM>& lambda, int ig
   else if (hd) {
     hd->SPalpha(spa);
   }
+  else if (hmg) {
+    hmg->SPalpha(spa);
+  }
   else {
     amrex::Abort("Should not be in RadSolve::levelSPas");    
   }
@@ -364,6 +470,9 @@ void RadSolve::levelBCoeffs(int level,
     else if (hm) {
 	hm->bCoefficients(level, bcoefs, idim);
     }
+    else if (hmg) {
+	hmg->bCoefficients(bcoefs, idim);
+    }
   } // -->> over dimension
 }
 
@@ -457,20 +566,56 @@ void RadSolve::levelRhs(int level, MultiFab& rhs,
 
 void RadSolve::levelSolve(int level,
                           MultiFab& Er, int igroup, MultiFab& rhs,
-                          Real sync_absres_factor)
+                          Real sync_absres_factor, bool reuse_setup)
 {
   BL_PROFILE("RadSolve::levelSolve");
 
-  // Set coeffs, build solver, solve
-  if (hd) {
-    hd->setScalars(alpha, beta);
+  // A group solver keeps its setup after the solve, and may reuse it.
+
+  GroupSolver* g = (current_group >= 0) ? &group_solvers[current_group] : NULL;
+
+  const bool do_setup = !(g && g->ready && reuse_setup);
+
+  Real strt = ParallelDescriptor::second();
+
+  // MLMG gets the coarse-fine boundary values from the coarse level
+  // solution, which may have changed since the last solve.  As in
+  // Radiation::filBndry, the coarse data is interpolated in time to
+  // this level's time, since with subcycling that falls between the
+  // coarse level's old and new times.
+  if (hmg && level > 0) {
+    AmrLevel& crse_level = parent->getLevel(level-1);
+    Real time = parent->getLevel(level).get_state_data(Rad_Type).curTime();
+    MultiFab Er_crse(crse_level.boxArray(), crse_level.DistributionMap(), 1, 0);
+    AmrLevel::FillPatch(crse_level, Er_crse, 0, time, Rad_Type,
+                        (igroup < 0) ? 0 : igroup, 1);
+    hmg->setCoarseData(Er_crse, 0, parent->refRatio(level-1)[0]);
   }
-  else if (hm) {
-    hm->setScalars(alpha, beta);
+
+  // Set coeffs, build solver, solve
+  if (do_setup) {
+    if (hd) {
+      if (g && g->ready) hd->clearSolver();
+      hd->setScalars(alpha, beta);
+      hd->setupSolver(reltol, abstol, maxiter);
+    }
+    else if (hm) {
+      if (g && g->ready) hm->clearSolver();
+      hm->setScalars(alpha, beta);
+      hm->loadMatrix();
+      hm->finalizeMatrix();
+    }
+    else if (hmg) {
+      if (g && g->ready) hmg->clearSolver();
+      hmg->setScalars(alpha, beta);
+      hmg->setupSolver(reltol, abstol, maxiter);
+    }
   }
 
   if (hd) {
-    hd->setupSolver(reltol, abstol, maxiter);
+    setup_time += ParallelDescriptor::second() - strt;
+    strt = ParallelDescriptor::second();
+
     hd->solve(Er, igroup, rhs, Inhomogeneous_BC);
     Real res = hd->getAbsoluteResidual();
     if (verbose >= 2 && ParallelDescriptor::IOProcessor()) {
@@ -480,14 +625,20 @@ void RadSolve::levelSolve(int level,
     }
     res *= sync_absres_factor;
     absres[level] = (absres[level] > res) ? absres[level] : res;
-    hd->clearSolver();
+    if (!g) hd->clearSolver();
+
+    solve_time += ParallelDescriptor::second() - strt;
   }
   else if (hm) {
-    hm->loadMatrix();
-    hm->finalizeMatrix();
     hm->loadLevelVectors(level, Er, igroup, rhs, Inhomogeneous_BC);
     hm->finalizeVectors();
-    hm->setupSolver(reltol, abstol, maxiter);
+    if (do_setup) {
+      hm->setupSolver(reltol, abstol, maxiter);
+    }
+
+    setup_time += ParallelDescriptor::second() - strt;
+    strt = ParallelDescriptor::second();
+
     hm->solve();
     hm->getSolution(level, Er, igroup);
     Real res = hm->getAbsoluteResidual();
@@ -498,8 +649,29 @@ void RadSolve::levelSolve(int level,
     }
     res *= sync_absres_factor;
     absres[level] = (absres[level] > res) ? absres[level] : res;
-    hm->clearSolver();
+    if (!g) hm->clearSolver();
+
+    solve_time += ParallelDescriptor::second() - strt;
+  }
+  else if (hmg) {
+    setup_time += ParallelDescriptor::second() - strt;
+    strt = ParallelDescriptor::second();
+
+    hmg->solve(Er, igroup, rhs, Inhomogeneous_BC);
+    Real res = hmg->getAbsoluteResidual();
+    if (verbose >= 2 && ParallelDescriptor::IOProcessor()) {
+      int oldprec = std::cout.precision(20);
+      std::cout << "Absolute residual = " << res << std::endl;
+      std::cout.precision(oldprec);
+    }
+    res *= sync_absres_factor;
+    absres[level] = (absres[level] > res) ? absres[level] : res;
+    if (!g) hmg->clearSolver();
+
+    solve_time += ParallelDescriptor::second() - strt;
   }
+
+  if (g) g->ready = true;
 }
 
 void RadSolve::levelFluxFaceToCenter(int level, const Tuple<MultiFab, BL_SPACEDIM>& Flux,
@@ -564,6 +736,9 @@ void RadSolve::levelFlux(int level,
     else if (hm) {
       bp = &hm->bCoefficients(level, n);
     }
+    else {
+      bp = &hmg->bCoefficients(n);
+    }
     // w.z. I commented this out because we may not always have ccoef 
     //      when use_hypre_nonsymmetric_terms == 1.
     //      And ccoef is not being used anyway.
@@ -600,6 +775,9 @@ void RadSolve::levelFlux(int level,
   else if (hm) {
     hm->boundaryFlux(level, &Flux[0], Er, igroup, Inhomogeneous_BC);
   }
+  else if (hmg) {
+    hmg->boundaryFlux(&Flux[0], Er, igroup, Inhomogeneous_BC);
+  }
   if (use_hypre_nonsymmetric_terms == 1) {
     //HypreExtMultiABec *hem = (HypreExtMultiABec*)hm;
     //hem->boundaryFlux(level, &Flux[0], Er);
@@ -812,6 +990,9 @@ void RadSolve::levelACoeffs(int level, MultiFab& kpp,
   else if (hm) {
     hm->aCoefficients(level,acoefs);
   }
+  else if (hmg) {
+    hmg->aCoefficients(acoefs);
+  }
 }
 
 
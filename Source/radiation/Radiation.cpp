@@ -199,7 +199,7 @@ void Radiation::read_static_params()
   }
 
   if (rad_hydro_combined) {
-    if (Castro::riemann_solver == 1) {
+    if (Castro::riemann_solver == 1 || Castro::riemann_solver == 3) {
       amrex::Error("The Colella and Glaz Riemann solver cannot be used with rad_hydro_combined.");
     }
   }
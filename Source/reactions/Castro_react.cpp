@@ -1,14 +1,42 @@
 
 #include "Castro.H"
 #include "Castro_F.H"
+#include "Castro_kernel_stats.H"
 
-#include "AMReX_DistributionMapping.H"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using std::string;
 using namespace amrex;
 
 #ifndef SDC
 
+namespace {
+
+    //
+    // A tile of the level and the zones in it that need burning,
+    // stored as (i,j,k) triples.
+    //
+    struct BurnTile {
+        int idx;                     // index of the grid
+        Box bx;                      // the zones we were asked to burn
+        Box tbx;                     // the valid part of bx, for the cost
+        Vector<int> zones;
+    };
+
+    //
+    // A piece of one tile's list, the unit of work for the threads.
+    //
+    struct BurnChunk {
+        int tile;
+        int first;
+        int nzones;
+        Real time;
+    };
+
+}
+
 void
 Castro::strang_react_first_half(Real time, Real dt)
 {
@@ -45,251 +73,254 @@ Castro::strang_react_first_half(Real time, Real dt)
 
     iMultiFab& interior_mask = build_interior_boundary_mask(ng);
 
-    // The reaction weightings.
+    if (verbose)
+        amrex::Print() << "... Entering burner and doing half-timestep of burning." << std::endl << std::endl;
 
-    MultiFab* weights;
+    react_state(state, reactions, interior_mask, time, dt, 1, ng);
 
-    // If we're using the custom knapsack weighting, copy state data
-    // to a new MultiFab with a corresponding distribution map.
+    if (verbose)
+        amrex::Print() << "... Leaving burner after completing half-timestep of burning." << std::endl << std::endl;
 
-    MultiFab* state_temp;
-    MultiFab* reactions_temp;
-    iMultiFab* mask_temp;
-    MultiFab* weights_temp;
+    state.FillBoundary(geom.periodicity());
 
-    // Use managed arrays so that we don't have to worry about
-    // deleting things at the end.
+    // Ensure consistency in internal energy and recompute temperature.
 
-    Vector<std::unique_ptr<MultiFab> > temp_data;
-    std::unique_ptr<iMultiFab> temp_idata;
+    clean_state(state);
 
-    if (use_custom_knapsack_weights) {
+}
 
-	weights = &get_old_data(Knapsack_Weight_Type);
 
-	// Note that we want to use the "old" data here; we've already
-	// done a swap on the new data for the old data, so this is
-	// really the new-time burn from the last timestep.
 
-	const DistributionMapping& dm = DistributionMapping::makeKnapSack(get_old_data(Knapsack_Weight_Type));
-	
-	temp_data.push_back(std::unique_ptr<MultiFab>(
-				state_temp = new MultiFab(state.boxArray(), dm, state.nComp(), state.nGrow())));
-	temp_data.push_back(std::unique_ptr<MultiFab>(
-				reactions_temp = new MultiFab(reactions.boxArray(), dm, reactions.nComp(), reactions.nGrow())));
-	temp_data.push_back(std::unique_ptr<MultiFab>(
-				weights_temp = new MultiFab(weights->boxArray(), dm, weights->nComp(), weights->nGrow())));
-	temp_idata.reset(mask_temp = new iMultiFab(interior_mask.boxArray(), dm, interior_mask.nComp(), interior_mask.nGrow()));
+void
+Castro::strang_react_second_half(Real time, Real dt)
+{
 
-	// Copy data from the state. Note that this is a parallel copy
-	// from FabArray, and the parallel copy assumes that the data
-	// on the ghost zones in state is valid and consistent with
-	// the data on the interior zones, since either the ghost or
-	// valid zones may end up filling a given destination zone.
+    MultiFab& reactions = get_new_data(Reactions_Type);
 
-	state_temp->copy(state, 0, 0, state.nComp(), state.nGrow(), state.nGrow());
+    // Ensure we always have valid data, even if we don't do the burn.
 
-	// Create the mask. We cannot use the interior_mask from above, generated by
-	// Castro::build_interior_boundary_mask, because we need it to exist on the
-	// current DistributionMap and a parallel copy won't work for the mask.
+    reactions.setVal(0.0);
 
-	int ghost_covered_by_valid = 0;
-	int other_cells = 1; // uncovered ghost, valid, and outside domain cells are set to 1
+    if (do_react != 1) return;
 
-	mask_temp->BuildMask(geom.Domain(), geom.periodicity(),
-		             ghost_covered_by_valid, other_cells, other_cells, other_cells);
+    MultiFab& state = get_new_data(State_Type);
 
-    }
-    else {
+    // Check if we have any zones to burn.
 
-	state_temp = &state;
-	reactions_temp = &reactions;
-	mask_temp = &interior_mask;
+    if (!valid_zones_to_burn(state)) return;
 
-	// Create a dummy weight array to pass to Fortran.
+    // To be consistent with other source term types,
+    // we are only applying this on the interior zones.
 
-	temp_data.push_back(std::unique_ptr<MultiFab>(
-				weights_temp = new MultiFab(reactions.boxArray(), reactions.DistributionMap(),
-							    reactions.nComp(), reactions.nGrow())));
+    const int ng = 0;
 
-    }
+    iMultiFab& interior_mask = build_interior_boundary_mask(ng);
 
     if (verbose)
         amrex::Print() << "... Entering burner and doing half-timestep of burning." << std::endl << std::endl;
 
-    react_state(*state_temp, *reactions_temp, *mask_temp, *weights_temp, time, dt, 1, ng);
+    react_state(state, reactions, interior_mask, time, dt, 2, ng);
 
     if (verbose)
         amrex::Print() << "... Leaving burner after completing half-timestep of burning." << std::endl << std::endl;
 
-    // Note that this FillBoundary *must* occur before we copy any data back
-    // to the main state data; it is the only way to ensure that the parallel
-    // copy to follow is sensible, because when we're working with ghost zones
-    // the valid and ghost zones must be consistent for the parallel copy.
+    state.FillBoundary(geom.periodicity());
 
-    state_temp->FillBoundary(geom.periodicity());
+    int is_new = 1;
+    clean_state(is_new, state.nGrow());
 
-    // Copy data back to the state data if necessary.
+}
 
-    if (use_custom_knapsack_weights) {
 
-	state.copy(*state_temp, 0, 0, state_temp->nComp(), state_temp->nGrow(), state_temp->nGrow());
-	reactions.copy(*reactions_temp, 0, 0, reactions_temp->nComp(), reactions_temp->nGrow(), reactions_temp->nGrow());
-	weights->copy(*weights_temp, 0, 0, weights_temp->nComp(), weights_temp->nGrow(), weights_temp->nGrow());
 
-    }
+void
+Castro::react_state(MultiFab& s, MultiFab& r, const iMultiFab& mask, Real time, Real dt_react, int strang_half, int ngrow)
+{
 
-    // Ensure consistency in internal energy and recompute temperature.
+    BL_PROFILE("Castro::react_state()");
 
-    clean_state(state);
+    KernelStats::Timer stats_timer(KernelStats::burn, level, grids, 2 * NUM_STATE + r.nComp());
 
-}
+    const Real strt_time = ParallelDescriptor::second();
 
+    // Start off assuming a successful burn.
 
+    burn_success = 1;
 
-void
-Castro::strang_react_second_half(Real time, Real dt)
-{
+    // The number of zones that failed to burn, and the number that
+    // failed at first but then succeeded with substepping.
 
-    MultiFab& reactions = get_new_data(Reactions_Type);
+    Real burn_failed = 0.0;
+    Real burn_recovered = 0.0;
 
-    // Ensure we always have valid data, even if we don't do the burn.
+#ifdef AMREX_USE_CUDA
+    for (MFIter mfi(s, true); mfi.isValid(); ++mfi)
+    {
 
-    reactions.setVal(0.0);
+	const Box& bx = mfi.growntilebox(ngrow);
 
-    if (Knapsack_Weight_Type > 0)
-        get_new_data(Knapsack_Weight_Type).setVal(1.0);
+	const Real cost_start = ParallelDescriptor::second();
 
-    if (do_react != 1) return;
+	// Note that box is *not* necessarily just the valid region!
+#pragma gpu
+	ca_react_state(AMREX_INT_ANYD(bx.loVect()), AMREX_INT_ANYD(bx.hiVect()),
+		       BL_TO_FORTRAN_ANYD(s[mfi]),
+		       BL_TO_FORTRAN_ANYD(r[mfi]),
+		       BL_TO_FORTRAN_ANYD(mask[mfi]),
+		       time, dt_react, strang_half,
+	               AMREX_MFITER_REDUCE_SUM(&burn_failed),
+	               AMREX_MFITER_REDUCE_SUM(&burn_recovered));
 
-    MultiFab& state = get_new_data(State_Type);
+	add_cost(mfi, ParallelDescriptor::second() - cost_start);
 
-    // Check if we have any zones to burn.
+    }
+#else
+    // The cost of a zone's burn varies by orders of magnitude, and
+    // many zones (masked, outside the react_T / react_rho limits, or
+    // too cold for the network) don't need burning at all, so dividing
+    // the level into tiles and giving each thread some of them leaves
+    // the threads badly out of balance. Instead, we make a list of the
+    // zones that do need burning in each tile, and hand that out to
+    // the threads in small chunks as they become free.
 
-    if (!valid_zones_to_burn(state)) return;
+    Vector<BurnTile> tiles;
 
-    // To be consistent with other source term types,
-    // we are only applying this on the interior zones.
+    for (MFIter mfi(s, true); mfi.isValid(); ++mfi)
+        tiles.push_back(BurnTile{mfi.index(), mfi.growntilebox(ngrow), mfi.tilebox()});
 
-    const int ng = 0;
+    const int ntiles = tiles.size();
 
-    iMultiFab& interior_mask = build_interior_boundary_mask(ng);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int t = 0; t < ntiles; ++t)
+    {
+        BurnTile& tile = tiles[t];
 
-    MultiFab* weights;
+	// Note that box is *not* necessarily just the valid region!
+        const Box& bx = tile.bx;
 
-    // Most of the following uses the same logic as strang_react_first_half;
-    // look there for explanatory comments.
+        tile.zones.resize(3 * bx.numPts());
 
-    MultiFab* state_temp;
-    MultiFab* reactions_temp;
-    iMultiFab* mask_temp;
-    MultiFab* weights_temp;
+        int nzones = 0;
 
-    Vector<std::unique_ptr<MultiFab> > temp_data;
-    std::unique_ptr<iMultiFab> temp_idata;
+        ca_burn_worklist(ARLIM_3D(bx.loVect()), ARLIM_3D(bx.hiVect()),
+                         BL_TO_FORTRAN_ANYD(s[tile.idx]),
+                         BL_TO_FORTRAN_ANYD(mask[tile.idx]),
+                         tile.zones.dataPtr(), &nzones);
 
-    if (use_custom_knapsack_weights) {
+        tile.zones.resize(3 * nzones);
+    }
 
-	weights = &get_new_data(Knapsack_Weight_Type);
+    Vector<BurnChunk> chunks;
 
-	// Here we use the old-time weights filled in during the first-half Strang-split burn.
+    const int chunk_size = std::max(react_chunk_size, 1);
 
-	const DistributionMapping& dm = DistributionMapping::makeKnapSack(get_old_data(Knapsack_Weight_Type));
+    for (int t = 0; t < ntiles; ++t) {
+        const int nzones = tiles[t].zones.size() / 3;
+        for (int first = 0; first < nzones; first += chunk_size)
+            chunks.push_back(BurnChunk{t, first, std::min(chunk_size, nzones - first), 0.0});
+    }
 
-	temp_data.push_back(std::unique_ptr<MultiFab>(
-				state_temp = new MultiFab(state.boxArray(), dm, state.nComp(), state.nGrow())));
-	temp_data.push_back(std::unique_ptr<MultiFab>(
-				reactions_temp = new MultiFab(reactions.boxArray(), dm, reactions.nComp(), reactions.nGrow())));
-	temp_data.push_back(std::unique_ptr<MultiFab>(
-				weights_temp = new MultiFab(weights->boxArray(), dm, weights->nComp(), weights->nGrow())));
-	temp_idata.reset(mask_temp = new iMultiFab(interior_mask.boxArray(), dm, interior_mask.nComp(), interior_mask.nGrow()));
+    const int nchunks = chunks.size();
 
-	state_temp->copy(state, 0, 0, state.nComp(), state.nGrow(), state.nGrow());
+#ifdef _OPENMP
+    Vector<Real> thread_time(omp_get_max_threads(), 0.0);
+#else
+    Vector<Real> thread_time(1, 0.0);
+#endif
 
-	int ghost_covered_by_valid = 0;
-	int other_cells = 1;
+#ifdef _OPENMP
+#pragma omp parallel reduction(+:burn_failed,burn_recovered)
+#endif
+    {
+        Real busy = 0.0;
 
-	mask_temp->BuildMask(geom.Domain(), geom.periodicity(),
-		             ghost_covered_by_valid, other_cells, other_cells, other_cells);
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic) nowait
+#endif
+        for (int c = 0; c < nchunks; ++c)
+        {
+            BurnChunk& chunk = chunks[c];
+            const BurnTile& tile = tiles[chunk.tile];
 
-    }
-    else {
+            const Real chunk_start = ParallelDescriptor::second();
 
-	state_temp = &state;
-	reactions_temp = &reactions;
-	mask_temp = &interior_mask;
+            ca_react_zones(&tile.zones[3 * chunk.first], chunk.nzones,
+                           BL_TO_FORTRAN_ANYD(s[tile.idx]),
+                           BL_TO_FORTRAN_ANYD(r[tile.idx]),
+                           time, dt_react,
+                           &burn_failed, &burn_recovered);
 
-	temp_data.push_back(std::unique_ptr<MultiFab>(
-				weights_temp = new MultiFab(reactions.boxArray(), reactions.DistributionMap(),
-							    reactions.nComp(), reactions.nGrow())));
+            chunk.time = ParallelDescriptor::second() - chunk_start;
+            busy += chunk.time;
+        }
 
+#ifdef _OPENMP
+        thread_time[omp_get_thread_num()] = busy;
+#else
+        thread_time[0] = busy;
+#endif
     }
 
-    if (verbose)
-        amrex::Print() << "... Entering burner and doing half-timestep of burning." << std::endl << std::endl;
+    // Charge each tile for the time spent burning its zones.
 
-    react_state(*state_temp, *reactions_temp, *mask_temp, *weights_temp, time, dt, 2, ng);
-
-    if (verbose)
-        amrex::Print() << "... Leaving burner after completing half-timestep of burning." << std::endl << std::endl;
+    if (load_balance_by_cost) {
 
-    state_temp->FillBoundary(geom.periodicity());
+        Vector<Real> tile_time(ntiles, 0.0);
 
-    if (use_custom_knapsack_weights) {
+        for (const BurnChunk& chunk : chunks)
+            tile_time[chunk.tile] += chunk.time;
 
-	state.copy(*state_temp, 0, 0, state_temp->nComp(), state_temp->nGrow(), state_temp->nGrow());
-	reactions.copy(*reactions_temp, 0, 0, reactions_temp->nComp(), reactions_temp->nGrow(), reactions_temp->nGrow());
-	weights->copy(*weights_temp, 0, 0, weights_temp->nComp(), weights_temp->nGrow(), weights_temp->nGrow());
+        for (int t = 0; t < ntiles; ++t)
+            add_cost(tiles[t].idx, tiles[t].tbx, tile_time[t]);
 
     }
 
-    int is_new = 1;
-    clean_state(is_new, state.nGrow());
-
-}
+    if (verbose > 0) {
 
+        // How many of the zones we were given needed burning, and how
+        // unevenly the time was shared among the threads (the busiest
+        // thread's time over the mean, taking the worst rank).
 
+        long zone_counts[2] = {0, 0};
 
-void
-Castro::react_state(MultiFab& s, MultiFab& r, const iMultiFab& mask, MultiFab& w, Real time, Real dt_react, int strang_half, int ngrow)
-{
-
-    BL_PROFILE("Castro::react_state()");
+        for (const BurnTile& tile : tiles) {
+            zone_counts[0] += tile.zones.size() / 3;
+            zone_counts[1] += tile.bx.numPts();
+        }
 
-    const Real strt_time = ParallelDescriptor::second();
+        Real max_time = 0.0;
+        Real sum_time = 0.0;
 
-    // Initialize the weights to the default value (everything is weighted equally).
+        for (Real t : thread_time) {
+            max_time = std::max(max_time, t);
+            sum_time += t;
+        }
 
-    w.setVal(1.0);
+        Real thread_imbalance = sum_time > 0.0 ? max_time * thread_time.size() / sum_time : 1.0;
 
-    // Start off assuming a successful burn.
+        ParallelDescriptor::ReduceLongSum(zone_counts, 2);
+        ParallelDescriptor::ReduceRealMax(thread_imbalance);
 
-    burn_success = 1;
-    Real burn_failed = 0.0;
+        amrex::Print() << "... burned " << zone_counts[0] << " of " << zone_counts[1]
+                       << " zones; thread load imbalance (max/mean) = " << thread_imbalance
+                       << std::endl << std::endl;
 
-#ifdef _OPENMP
-#pragma omp parallel
+    }
 #endif
-    for (MFIter mfi(s, true); mfi.isValid(); ++mfi)
-    {
 
-	const Box& bx = mfi.growntilebox(ngrow);
+    Real burn_zones[2] = {burn_failed, burn_recovered};
 
-	// Note that box is *not* necessarily just the valid region!
-#pragma gpu
-	ca_react_state(AMREX_INT_ANYD(bx.loVect()), AMREX_INT_ANYD(bx.hiVect()),
-		       BL_TO_FORTRAN_ANYD(s[mfi]),
-		       BL_TO_FORTRAN_ANYD(r[mfi]),
-		       BL_TO_FORTRAN_ANYD(w[mfi]),
-		       BL_TO_FORTRAN_ANYD(mask[mfi]),
-		       time, dt_react, strang_half,
-	               AMREX_MFITER_REDUCE_SUM(&burn_failed));
+    ParallelDescriptor::ReduceRealSum(burn_zones, 2);
 
-    }
+    if (burn_zones[0] != 0.0) burn_success = 0;
 
-    if (burn_failed != 0.0) burn_success = 0;
+    num_burn_recoveries += burn_zones[1];
 
-    ParallelDescriptor::ReduceIntMin(burn_success);
+    if (verbose > 0 && (burn_zones[0] != 0.0 || burn_zones[1] != 0.0))
+        amrex::Print() << "... burn failed in " << burn_zones[0] << " zones; "
+                       << burn_zones[1] << " zones recovered by substepping" << std::endl << std::endl;
 
     if (print_update_diagnostics) {
 
@@ -327,6 +358,8 @@ Castro::react_state(Real time, Real dt)
 {
     BL_PROFILE("Castro::react_state()");
 
+    KernelStats::Timer stats_timer(KernelStats::burn, level, grids, 2 * NUM_STATE);
+
     const Real strt_time = ParallelDescriptor::second();
 
     if (verbose)
@@ -363,6 +396,8 @@ Castro::react_state(Real time, Real dt)
 	FArrayBox& r       = reactions[mfi];
 	const IArrayBox& m = interior_mask[mfi];
 
+	const Real cost_start = ParallelDescriptor::second();
+
 	ca_react_state(ARLIM_3D(bx.loVect()), ARLIM_3D(bx.hiVect()),
 		       uold.dataPtr(), ARLIM_3D(uold.loVect()), ARLIM_3D(uold.hiVect()),
 		       unew.dataPtr(), ARLIM_3D(unew.loVect()), ARLIM_3D(unew.hiVect()),
@@ -371,6 +406,8 @@ Castro::react_state(Real time, Real dt)
 		       m.dataPtr(), ARLIM_3D(m.loVect()), ARLIM_3D(m.hiVect()),
 		       time, dt, sdc_iteration);
 
+	add_cost(mfi, ParallelDescriptor::second() - cost_start);
+
     }
 
     if (ng > 0)
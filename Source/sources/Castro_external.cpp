@@ -67,6 +67,8 @@ Castro::fill_ext_source (Real time, Real dt, MultiFab& state_old, MultiFab& stat
 
         const Box& bx = mfi.tilebox();
 
+        const Real cost_start = ParallelDescriptor::second();
+
 #ifdef AMREX_DIMENSION_AGNOSTIC
         BL_FORT_PROC_CALL(CA_EXT_SRC,ca_ext_src)
 	  (ARLIM_3D(bx.loVect()), ARLIM_3D(bx.hiVect()),
@@ -82,5 +84,7 @@ Castro::fill_ext_source (Real time, Real dt, MultiFab& state_old, MultiFab& stat
 	   BL_TO_FORTRAN(ext_src[mfi]),
 	   prob_lo,dx,&time,&dt);
 #endif
+
+        add_cost(mfi, ParallelDescriptor::second() - cost_start);
     }
 }
@@ -5,12 +5,15 @@
 #include <iomanip>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
 #include <cstdio>
 #include <vector>
 #include <string>
+#include <memory>
+#include <algorithm>
 
 #ifndef WIN32
 #include <unistd.h>
@@ -24,6 +27,7 @@
 #include "AMReX_DataServices.H"
 #include "AMReX_Utility.H"
 #include "AMReX_VisMF.H"
+#include "AMReX_FPC.H"
 #include "AMReX_Geometry.H"
 #include "AMReX_StateDescriptor.H"
 #include "AMReX_StateData.H"
@@ -60,6 +64,10 @@ int   grown_factor(1);
 int star_at_center(-1);
 int   max_grid_size(4096);
 int   coord(-1);
+bool stream(false);
+Vector<int> ref_ratios;
+Real max_mb(1024.0);
+Vector<IntVect> stream_shift;
 const std::string CheckPointVersion = "CheckPointVersion_1.0";
 
 Vector<int> nsets_save(1);
@@ -80,6 +88,8 @@ struct FakeStateData {
     MultiFab *new_data;
     MultiFab *old_data;
     Vector< Vector<BCRec> > bc;
+    int nsets;                  // Used by the streaming mode, which
+    std::string mf_name[2];     // keeps the data on disk (new, old).
 };
 
 
@@ -126,8 +136,18 @@ static void ScanArguments() {
     if(pp.contains("verbose")) {
       pp.get("verbose", verbose);
     }
+    if(pp.contains("stream")) {
+      pp.get("stream", stream);
+    }
+    if(pp.contains("max_mb")) {
+      pp.get("max_mb", max_mb);
+    }
     if(pp.contains("ref_ratio")) {
-      pp.get("ref_ratio", ref_ratio);
+      if (stream) {
+        pp.getarr("ref_ratio", ref_ratios);
+      } else {
+        pp.get("ref_ratio", ref_ratio);
+      }
     }
 
     if(pp.contains("grown_factor")) {
@@ -139,6 +159,31 @@ static void ScanArguments() {
     if (star_at_center != 0 && star_at_center != 1)
        amrex::Abort("star_at_center must be 0 or 1");
 
+    if (stream) {
+
+       // Any number of new levels, each 2 or 4 times coarser than the
+       // one above it, and the domain need not grow.
+
+       if (ref_ratios.size() == 0)
+          amrex::Abort("must give at least one ref_ratio");
+
+       for (int i = 0; i < ref_ratios.size(); i++)
+          if (ref_ratios[i] != 2 && ref_ratios[i] != 4)
+             amrex::Abort("each ref_ratio must be 2 or 4");
+
+       if (grown_factor < 1)  
+           amrex::Abort("must have grown_factor >= 1");
+
+       if (max_mb <= 0.0)  
+           amrex::Abort("must have max_mb > 0");
+
+       if (star_at_center == 1 && grown_factor > 1)  
+          if (grown_factor != 2 && grown_factor != 3)
+             amrex::Abort("must have grown_factor = 2 or 3 for star at center");
+
+       return;
+    }
+
     if (ref_ratio != 2 && ref_ratio != 4)
        amrex::Abort("ref_ratio must be 2 or 4");
 
@@ -159,6 +204,13 @@ static void PrintUsage (char *progName) {
          << "star_at_center =0 or 1  "   
          << "[nfiles=nfilesout] "
          << "[verbose=trueorfalse]" << endl;
+    cout << "   or: " << progName << " stream=1 checkin=filename "
+         << "checkout=outfilename "  
+         << "ref_ratio=r0 [r1 ...] (each 2 or 4) "   
+         << "grown_factor=integer "   
+         << "star_at_center =0 or 1  "   
+         << "[max_mb=MB per rank] "
+         << "[verbose=trueorfalse]" << endl;
     exit(1);
 }
 
@@ -476,25 +528,10 @@ static void ReadCheckpointFile(const std::string& fileName) {
 }
 
 // ---------------------------------------------------------------
-static void WriteCheckpointFile(const std::string& inFileName, const std::string &outFileName) {
-    VisMF::SetNOutFiles(nFiles);
-    // In checkpoint files always write out FABs in NATIVE format.
-    FABio::Format thePrevFormat = FArrayBox::getFormat();
-    FArrayBox::setFormat(FABio::FAB_NATIVE);
-
-    const std::string ckfile = outFileName;
-
-    // Only the I/O processor makes the directory if it doesn't already exist.
-    if(ParallelDescriptor::IOProcessor()) {
-      if( ! amrex::UtilCreateDirectory(ckfile, 0755)) {
-        amrex::CreateDirectoryFailed(ckfile);
-      }
-    }
-    // Force other processors to wait till directory is built.
-    ParallelDescriptor::Barrier();
+// Copy the Castro-specific header to the new checkpoint.  Only one
+// processor (the I/O processor) needs to do this.
 
-    // Copy some standard auxiliary files to the new checkpoint.
-    // Only one processor (the I/O processor) needs to do this.
+static void CopyCastroHeader(const std::string& inFileName, const std::string &outFileName) {
 
     if (ParallelDescriptor::IOProcessor()) {
 
@@ -520,30 +557,13 @@ static void WriteCheckpointFile(const std::string& inFileName, const std::string
       }
 
     }
+}
 
-    // Write the main header file.
-
-    std::string HeaderFileName = ckfile + "/Header";
-
-    VisMF::IO_Buffer io_buffer(VisMF::IO_Buffer_Size);
-
-    std::ofstream HeaderFile;
-
-    HeaderFile.rdbuf()->pubsetbuf(io_buffer.dataPtr(), io_buffer.size());
-
-    int old_prec(0), i;
-
-    if(ParallelDescriptor::IOProcessor()) {
-        // Only the IOProcessor() writes to the header file.
-        HeaderFile.open(HeaderFileName.c_str(),
-	                std::ios::out|std::ios::trunc|std::ios::binary);
-
-        if( ! HeaderFile.good()) {
-          amrex::FileOpenFailed(HeaderFileName);
-	}
-
-        old_prec = HeaderFile.precision(15);
+// ---------------------------------------------------------------
+// Write the part of the main header that comes before the levels.
 
+static void WriteHeaderGlobals(std::ostream& HeaderFile) {
+	int i;
 	int max_level(fakeAmr.finest_level);
         HeaderFile << CheckPointVersion << '\n'
                    << BL_SPACEDIM       << '\n'
@@ -567,6 +587,53 @@ static void WriteCheckpointFile(const std::string& inFileName, const std::string
         HeaderFile << '\n';
         for (i = 0; i <= max_level; i++) HeaderFile << fakeAmr.level_count[i] << ' ';
         HeaderFile << '\n';
+}
+
+// ---------------------------------------------------------------
+static void WriteCheckpointFile(const std::string& inFileName, const std::string &outFileName) {
+    VisMF::SetNOutFiles(nFiles);
+    // In checkpoint files always write out FABs in NATIVE format.
+    FABio::Format thePrevFormat = FArrayBox::getFormat();
+    FArrayBox::setFormat(FABio::FAB_NATIVE);
+
+    const std::string ckfile = outFileName;
+
+    // Only the I/O processor makes the directory if it doesn't already exist.
+    if(ParallelDescriptor::IOProcessor()) {
+      if( ! amrex::UtilCreateDirectory(ckfile, 0755)) {
+        amrex::CreateDirectoryFailed(ckfile);
+      }
+    }
+    // Force other processors to wait till directory is built.
+    ParallelDescriptor::Barrier();
+
+    // Copy some standard auxiliary files to the new checkpoint.
+    CopyCastroHeader(inFileName, outFileName);
+
+    // Write the main header file.
+
+    std::string HeaderFileName = ckfile + "/Header";
+
+    VisMF::IO_Buffer io_buffer(VisMF::IO_Buffer_Size);
+
+    std::ofstream HeaderFile;
+
+    HeaderFile.rdbuf()->pubsetbuf(io_buffer.dataPtr(), io_buffer.size());
+
+    int old_prec(0);
+
+    if(ParallelDescriptor::IOProcessor()) {
+        // Only the IOProcessor() writes to the header file.
+        HeaderFile.open(HeaderFileName.c_str(),
+	                std::ios::out|std::ios::trunc|std::ios::binary);
+
+        if( ! HeaderFile.good()) {
+          amrex::FileOpenFailed(HeaderFileName);
+	}
+
+        old_prec = HeaderFile.precision(15);
+
+        WriteHeaderGlobals(HeaderFile);
     }
 
     for(int lev(0); lev <= fakeAmr.finest_level; ++lev) {
@@ -698,6 +765,87 @@ static void WriteCheckpointFile(const std::string& inFileName, const std::string
     FArrayBox::setFormat(thePrevFormat);
 }
 
+// ---------------------------------------------------------------
+// The problem domain grown by grown_factor, around the star.
+
+static RealBox GrownProbDomain(const RealBox& rb_in) {
+
+   RealBox rb(rb_in);
+
+   // If this is an octant then we always grow only in the high directions
+   if (star_at_center == 0)
+   {
+      // Here we grow only prob_hi, extending the domain in one direction.
+      // This works when the star's center is at the origin
+      for (int dm = 0; dm < BL_SPACEDIM; dm++) 
+         rb.setHi(dm,grown_factor*rb.hi(dm));
+   } 
+
+   // We treat the r-z case with the star in the middle specially
+#if (BL_SPACEDIM == 2)
+   else if (coord == 1)
+   {
+      // Here we grow only prob_hi in the r-direction, but both prob_hi
+      //   and prob_lo in the z-direction.
+     int dm = 0;
+     rb.setHi(dm,grown_factor*rb.hi(dm));
+
+     dm = 1;
+     Real dist   = 0.5 * (rb.hi(dm)-rb.lo(dm));
+     Real center = 0.5 * (rb.hi(dm)+rb.lo(dm));
+     Real newlo = center - grown_factor * dist;
+     Real newhi = center + grown_factor * dist;
+     rb.setLo(dm,newlo);
+     rb.setHi(dm,newhi);
+   }
+#endif
+
+   // This has star_at_center = 0 
+   else 
+   {
+      // Here we grow prob_lo and prob_hi, extending the domain in all directions.
+      // This works when the star's center is at the center of the domain.
+      for (int dm = 0; dm < BL_SPACEDIM; dm++) 
+      {
+         Real dist   = 0.5 * (rb.hi(dm)-rb.lo(dm));
+         Real center = 0.5 * (rb.hi(dm)+rb.lo(dm));
+         Real newlo = center - grown_factor * dist;
+         Real newhi = center + grown_factor * dist;
+         rb.setLo(dm,newlo);
+         rb.setHi(dm,newhi);
+      }
+   }
+
+   return rb;
+}
+
+// ---------------------------------------------------------------
+// How far the data on a level with the (not yet grown) domain is
+// shifted so that the star stays at the center of the grown domain.
+
+static IntVect StarShift(const Box& domain) {
+
+   IntVect shift_iv(IntVect::TheZeroVector());
+
+   if (star_at_center == 1)
+   {
+      if (coord == 1) // r-z
+      {
+         // We only handle grown_factor = 2
+         shift_iv[0] = 0;
+         shift_iv[1] = domain.size()[1] / 2;
+      } else if (coord == 0) { // x-y
+         if (grown_factor == 3) {
+            shift_iv = domain.size();
+         } else if (grown_factor == 2) {
+            shift_iv = domain.size() / 2;
+         }
+      }
+   } 
+
+   return shift_iv;
+}
+
 // ---------------------------------------------------------------
 
 static void ConvertData() {
@@ -819,51 +967,7 @@ static void ConvertData() {
    // Enlarge the ProbDomain (RealBox) of the geom at each level --
    //   but we only have to do this at level 0 because they are
    //   actually all the same copy 
-   RealBox rb(fakeAmr.geom[0].ProbDomain());
-
-   // If this is an octant then we always grow only in the high directions
-   if (star_at_center == 0)
-   {
-      // Here we grow only prob_hi, extending the domain in one direction.
-      // This works when the star's center is at the origin
-      for (int dm = 0; dm < BL_SPACEDIM; dm++) 
-         rb.setHi(dm,grown_factor*rb.hi(dm));
-   } 
-
-   // We treat the r-z case with the star in the middle specially
-#if (BL_SPACEDIM == 2)
-   else if (coord == 1)
-   {
-      // Here we grow only prob_hi in the r-direction, but both prob_hi
-      //   and prob_lo in the z-direction.
-     int dm = 0;
-     rb.setHi(dm,grown_factor*rb.hi(dm));
-
-     dm = 1;
-     Real dist   = 0.5 * (rb.hi(dm)-rb.lo(dm));
-     Real center = 0.5 * (rb.hi(dm)+rb.lo(dm));
-     Real newlo = center - grown_factor * dist;
-     Real newhi = center + grown_factor * dist;
-     rb.setLo(dm,newlo);
-     rb.setHi(dm,newhi);
-   }
-#endif
-
-   // This has star_at_center = 0 
-   else 
-   {
-      // Here we grow prob_lo and prob_hi, extending the domain in all directions.
-      // This works when the star's center is at the center of the domain.
-      for (int dm = 0; dm < BL_SPACEDIM; dm++) 
-      {
-         Real dist   = 0.5 * (rb.hi(dm)-rb.lo(dm));
-         Real center = 0.5 * (rb.hi(dm)+rb.lo(dm));
-         Real newlo = center - grown_factor * dist;
-         Real newhi = center + grown_factor * dist;
-         rb.setLo(dm,newlo);
-         rb.setHi(dm,newhi);
-      }
-   }
+   RealBox rb(GrownProbDomain(fakeAmr.geom[0].ProbDomain()));
 
    fakeAmr.geom[0].ProbDomain(rb);
    const Real* xlo = fakeAmr.geom[0].ProbLo();
@@ -875,29 +979,8 @@ static void ConvertData() {
    IntVect shift_iv[max_level+1];
 
    // Define the shift IntVect for later
-   if (star_at_center == 1)
-   {
-      if (coord == 1) // r-z
-      {
-         for (int i = 0; i <= max_level; i++) 
-         {
-            Box domain(fakeAmr.geom[i].Domain());
-            // We only handle grown_factor = 2
-            shift_iv[i][0] = 0;
-            shift_iv[i][1] = domain.size()[1] / 2;
-         }
-      } else if (coord == 0) { // x-y
-         for (int i = 0; i <= max_level; i++) 
-         {
-            Box domain(fakeAmr.geom[i].Domain());
-            if (grown_factor == 3) {
-               shift_iv[i] = domain.size();
-            } else if (grown_factor == 2) {
-               shift_iv[i] = domain.size() / 2;
-            }
-         }
-      }
-   } 
+   for (int i = 0; i <= max_level; i++) 
+      shift_iv[i] = StarShift(fakeAmr.geom[i].Domain());
 
    // Enlarge the Domain (Box) of the geom at each level
    for (int i = 0; i <= max_level; i++) 
@@ -981,36 +1064,769 @@ static void ConvertData() {
 
 
 // ---------------------------------------------------------------
-int main(int argc, char *argv[]) {
-    amrex::Initialize(argc,argv);
+// The streaming mode (stream=1).  This adds any number of coarser
+// levels, one for each value of ref_ratio, and grows the domain, in
+// one pass.  The data are never all in memory: the new checkpoint is
+// written one box at a time, spread over the MPI ranks, and the boxes
+// are small enough that a rank holds at most about max_mb MB of data
+// at once.  The old levels are shifted and copied, ghost zones and
+// all, and each new level is averaged down from the level above it as
+// written to the new checkpoint, ghost zones included wherever finer
+// data cover them.
+// ---------------------------------------------------------------
 
-    if(argc < 3) {
-      PrintUsage(argv[0]);
-    }
+static void ReadCheckpointHeaders(const std::string& fileName) {
+    int i;
+    std::string File = fileName;
 
-    ScanArguments();
+    File += '/';
+    File += "Header";
 
-    if(verbose && ParallelDescriptor::IOProcessor()) {
-      cout << " " << std::endl;
-      cout << "Reading from old checkpoint file: " <<  CheckFileIn << endl;
-      cout << " " << std::endl;
-    }
+    VisMF::IO_Buffer io_buffer(VisMF::IO_Buffer_Size);
 
-    if(verbose && ParallelDescriptor::IOProcessor()) {
-      if (star_at_center == 0) cout << "Star at corner " << endl;
-      if (star_at_center == 1) cout << "Star at center " << endl;
-      cout << " " << std::endl;
+    std::ifstream is;
+    is.rdbuf()->pubsetbuf(io_buffer.dataPtr(), io_buffer.size());
+    is.open(File.c_str(), std::ios::in);
+    if( ! is.good()) {
+        amrex::FileOpenFailed(File);
     }
 
-    // Read in the original checkpoint directory and add a coarser level covering the same domain 
-    ReadCheckpointFile(CheckFileIn);
+    int         spdim;
+    bool        new_checkpoint_format = false;
+    std::string first_line;
 
-    // Enlarge the new level 0
-    ConvertData();
+    std::getline(is,first_line);
+
+    if (first_line == CheckPointVersion) {
+        new_checkpoint_format = true;
+        is >> spdim;
+    } else {
+        spdim = atoi(first_line.c_str());
+    }
+
+    if(spdim != BL_SPACEDIM) {
+        cerr << "Amr::restart(): bad spacedim = " << spdim << '\n';
+        amrex::Abort();
+    }
+
+    is >> fakeAmr.cumtime;
+    int mx_lev;
+    is >> mx_lev;
+    is >> fakeAmr.finest_level;
+
+    // ADDING LEVELS
+    const int n = ref_ratios.size();
+    mx_lev = mx_lev + n;
+    fakeAmr.finest_level = fakeAmr.finest_level + n;
+
+    if(ParallelDescriptor::IOProcessor()) {
+       std::cout << "previous finest_lev is " << fakeAmr.finest_level-n << std::endl;
+       std::cout << "     new finest_lev is " << fakeAmr.finest_level << std::endl;
+    }
+
+    fakeAmr.geom.resize(mx_lev + 1);
+    fakeAmr.ref_ratio.resize(mx_lev);
+    fakeAmr.dt_level.resize(mx_lev + 1);
+    fakeAmr.dt_min.resize(mx_lev + 1);
+    fakeAmr.n_cycle.resize(mx_lev + 1);
+    fakeAmr.level_steps.resize(mx_lev + 1);
+    fakeAmr.level_count.resize(mx_lev + 1);
+    fakeAmr.fakeAmrLevels.resize(mx_lev + 1);
+
+    for (i = n; i <= mx_lev; i++) is >> fakeAmr.geom[i];
+    for (i = n; i <  mx_lev; i++) is >> fakeAmr.ref_ratio[i];
+    for (i = n; i <= mx_lev; i++) is >> fakeAmr.dt_level[i];
+
+    if (new_checkpoint_format) {
+      for (i = n; i <= mx_lev; i++) is >> fakeAmr.dt_min[i];
+    }
+
+    for (i = n; i <= mx_lev; i++) is >> fakeAmr.n_cycle[i];
+    for (i = n; i <= mx_lev; i++) is >> fakeAmr.level_steps[i];
+    for (i = n; i <= mx_lev; i++) is >> fakeAmr.level_count[i];
+
+    // Make sure the old domain is divisible by 2 times the total
+    // ref_ratio, so the coarsest domain has an even length
+    int total_ratio = 1;
+    for (i = 0; i < n; i++) total_ratio *= ref_ratios[i];
+
+    Box dom0(fakeAmr.geom[n].Domain());
+    for (int d = 0; d < BL_SPACEDIM; d++)
+      if (dom0.size()[d] % (2*total_ratio) != 0)
+        amrex::Abort("must have domain divisible by 2*(product of the ref_ratios)");
+
+    RealBox prob_domain(fakeAmr.geom[n].ProbDomain());
+    coord = fakeAmr.geom[n].Coord();
+
+    // Define the new levels, from the old level 0 down
+    for (int lev = n-1; lev >= 0; lev--) {
+
+      const int r = ref_ratios[lev];
+
+      Box domain(amrex::coarsen(fakeAmr.geom[lev+1].Domain(), r));
+      fakeAmr.geom[lev].define(domain,&prob_domain,coord);
+
+      fakeAmr.ref_ratio[lev] = r * IntVect::TheUnitVector();
+      fakeAmr.dt_level[lev]  = fakeAmr.dt_level[lev+1] * r;
+      if (new_checkpoint_format)
+        fakeAmr.dt_min[lev]  = fakeAmr.dt_min[lev+1] * r;
+
+      // The level above now takes r steps for each one of this level
+      fakeAmr.n_cycle[lev+1] = r;
+
+      fakeAmr.level_steps[lev] = fakeAmr.level_steps[lev+1] / r;
+      if ( (fakeAmr.level_steps[lev]*r) != fakeAmr.level_steps[lev+1] ) 
+         amrex::Abort("Number of steps in original checkpoint must be divisible by the product of the ref_ratios");
+
+      // level_count is how many steps we've taken at this level since the last regrid
+      if (fakeAmr.level_count[lev+1] == fakeAmr.level_steps[lev+1]) {
+         fakeAmr.level_count[lev] = fakeAmr.level_steps[lev];
+      } else {
+         fakeAmr.level_count[lev] = std::min(fakeAmr.level_count[lev+1],fakeAmr.level_steps[lev]);
+      }
+    }
+
+    // n_cycle is always equal to 1 at the coarsest level 
+    fakeAmr.n_cycle[0] = 1;
+
+    if (!new_checkpoint_format)
+      for (i = 0; i <= mx_lev; i++) fakeAmr.dt_min[i] = fakeAmr.dt_level[i];
+
+    // READ LEVEL DATA -- only the names of the MultiFabs, not the data
+    for(int lev(n); lev <= fakeAmr.finest_level; ++lev) {
+
+      FakeAmrLevel &falRef = fakeAmr.fakeAmrLevels[lev];
+
+      is >> falRef.level;
+      falRef.level = falRef.level + n;
+
+      is >> falRef.geom;
+
+      falRef.grids.readFrom(is);
+
+      int ndesc;
+      is >> ndesc;
+
+      falRef.state.resize(ndesc);
+
+      for(int i = 0; i < ndesc; i++) {
+
+        FakeStateData &sd = falRef.state[i];
+
+        is >> sd.domain;
+
+        sd.grids.readFrom(is);
+
+        is >> sd.old_time.start;
+        is >> sd.old_time.stop;
+        is >> sd.new_time.start;
+        is >> sd.new_time.stop;
+
+        is >> sd.nsets;
+
+        sd.old_data = 0;
+        sd.new_data = 0;
+
+        // Note that the names are relative to the Header file.
+        for (int set = 0; set < sd.nsets; set++) {
+           std::string mf_name;
+           is >> mf_name;
+           sd.mf_name[set] = fileName;
+           if( ! fileName.empty() && fileName[fileName.length()-1] != '/') {
+             sd.mf_name[set] += '/';
+           }
+           sd.mf_name[set] += mf_name;
+        }
+      }
+    }
+}
+
+// ---------------------------------------------------------------
+// Lay out the grids of every level in the grown domain.
+
+static void SetupStreamedLevels() {
+
+    const int n = ref_ratios.size();
+    const int finest_level = fakeAmr.finest_level;
+
+    FakeAmrLevel &falRef_orig = fakeAmr.fakeAmrLevels[n];
+    const int ndesc = falRef_orig.state.size();
+
+    // Find the largest box (in cells on a side) for which the data we
+    // build, plus the weights for the average down, fit in max_mb.  The
+    // old data are read straight into it, or a row at a time, so this
+    // is all a rank holds, however large the old boxes are.
+
+    int ncomp_max = 1;
+    int ngrow_max = 0;
+
+    for (int i = 0; i < ndesc; i++) {
+      if (falRef_orig.state[i].nsets >= 1) {
+        VisMF vmf(falRef_orig.state[i].mf_name[0]);
+        ncomp_max = std::max(ncomp_max, vmf.nComp());
+        ngrow_max = std::max(ngrow_max, vmf.nGrow());
+      }
+    }
+
+    const Real cells = max_mb * 1024.0 * 1024.0 / (sizeof(Real) * (ncomp_max + 1));
+    int box_len = int(std::pow(cells, 1.0/BL_SPACEDIM)) - 2*ngrow_max;
+    if (box_len >= 16) box_len -= box_len % 8;
+    box_len = std::max(box_len, 8);
+
+    // The new levels are broken up no more finely than the old level 0
+    int max_len = 0;
+    const BoxArray& g = falRef_orig.grids;
+    for (int b = 0; b < g.size(); b++)
+       for (int d = 0; d < BL_SPACEDIM; d++)
+         max_len = std::max(max_len, g[b].length(d));
+    max_grid_size = std::min(max_len, box_len);
+
+    if (verbose && ParallelDescriptor::IOProcessor()) {
+       std::cout << "Boxes are at most " << box_len << " cells on a side ("
+                 << max_grid_size << " on the new levels)" << std::endl;
+       std::cout << " " << std::endl;
+    }
+
+    // Grow the problem domain
+    RealBox rb(GrownProbDomain(fakeAmr.geom[0].ProbDomain()));
+
+    stream_shift.resize(finest_level + 1);
+
+    for (int lev = 0; lev <= finest_level; lev++) {
+
+      FakeAmrLevel &falRef = fakeAmr.fakeAmrLevels[lev];
+
+      // Where the old domain sits in the grown one
+      Box domain(fakeAmr.geom[lev].Domain());
+
+      stream_shift[lev] = IntVect::TheZeroVector();
+      if (grown_factor > 1)
+        stream_shift[lev] = StarShift(domain);
+
+      Box orig_domain(amrex::shift(domain, stream_shift[lev]));
+
+      Box new_domain(amrex::refine(domain, grown_factor));
+
+      fakeAmr.geom[lev].define(new_domain,&rb,coord);
+
+      if (lev >= n) {
+
+        // The old grids, moved with the star and broken up as needed
+        BoxArray new_grids(falRef.grids);
+        new_grids.shift(stream_shift[lev]);
+        new_grids.maxSize(box_len);
+        falRef.grids = new_grids;
+
+      } else {
+
+        // Cover the old domain, and at level 0 the rest of the grown
+        // domain too, with boxes that are each inside or outside of
+        // the old domain, as Castro expects on restart
+        BoxList new_grids(orig_domain);
+        new_grids.maxSize(max_grid_size);
+
+        if (lev == 0) {
+          BoxList outside = amrex::complementIn(new_domain, BoxList(orig_domain));
+          outside.maxSize(max_grid_size);
+          new_grids.join(outside);
+        }
+
+        falRef.grids = BoxArray(new_grids);
+        falRef.level = lev;
+
+        falRef.state.resize(ndesc);
+
+        for(int i = 0; i < ndesc; i++) {
+          FakeStateData &sd = falRef.state[i];
+          sd.nsets = falRef_orig.state[i].nsets;
+          sd.new_time.start = falRef_orig.state[i].new_time.start;
+          sd.new_time.stop  = falRef_orig.state[i].new_time.stop;
+          sd.old_time.start = sd.new_time.start - fakeAmr.dt_level[lev];
+          sd.old_time.stop  = sd.new_time.stop  - fakeAmr.dt_level[lev];
+          sd.old_data = 0;
+          sd.new_data = 0;
+        }
+
+      }
+
+      falRef.geom = fakeAmr.geom[lev];
+
+      for(int i = 0; i < ndesc; i++) {
+        falRef.state[i].domain = new_domain;
+        falRef.state[i].grids = falRef.grids;
+      }
+    }
+
+    // This sets the CoordSys member "offset" which should be identical to Geometry's problo
+    //    but isn't automatically set.
+    for (int lev = 0; lev <= finest_level; lev++)
+      fakeAmr.geom[lev].SetOffset(rb.lo());
+}
+
+// ---------------------------------------------------------------
+// The volume of a cell on level lev, up to a constant factor, for the
+// average down; it only varies in r-z and spherical coordinates.
+
+static Real CellVolume(const IntVect& iv, int lev) {
+
+    if (coord == 0) return 1.0;
+
+    const Real dr = fakeAmr.geom[lev].CellSize()[0];
+    const Real r  = fakeAmr.geom[lev].ProbLo()[0] + (iv[0] + 0.5) * dr;
+
+    if (coord == 1) return r;
+
+    return r * r + dr * dr / 12.0;
+}
+
+// ---------------------------------------------------------------
+// Reads runs of cells of a MultiFab on disk, one component at a time,
+// so that only the cells that are needed are read, and nothing but the
+// caller's buffer is held.  The FABs must be in the native format, as
+// checkpoints are written; the boxes are shifted by shift.
+
+struct FabRunReader {
+
+    FabRunReader(const std::string& mf_name, const IntVect& shift, int ngrow)
+      : dir_name(VisMF::DirName(mf_name)),
+        io_buffer(VisMF::IO_Buffer_Size)
+    {
+      std::ifstream his(mf_name + "_H");
+      if( ! his.good()) {
+        amrex::FileOpenFailed(mf_name + "_H");
+      }
+      his >> hdr;
+
+      fab_box = BoxArray(hdr.m_ba);
+      fab_box.shift(shift);
+      fab_box.grow(ngrow);
+
+      data_start.resize(fab_box.size(), -1);
+
+      std::ostringstream native;
+      native << FPC::NativeRealDescriptor();
+      native_desc = native.str();
+    }
+
+    // Read len cells of component c of FAB j, starting at iv and
+    // running along x, then on through the higher directions.
+    void read(int j, int c, const IntVect& iv, long len, Real* buf) {
+
+      const VisMF::FabOnDisk& fod = hdr.m_fod[j];
+      const std::string fab_file = dir_name + fod.m_name;
+
+      if (fab_file != file_name) {
+        if (is.is_open()) is.close();
+        is.rdbuf()->pubsetbuf(io_buffer.dataPtr(), io_buffer.size());
+        is.open(fab_file.c_str(), std::ios::in|std::ios::binary);
+        if( ! is.good()) {
+          amrex::FileOpenFailed(fab_file);
+        }
+        file_name = fab_file;
+      }
+
+      if (data_start[j] < 0) {
+        std::string line;
+        is.seekg(fod.m_head, std::ios::beg);
+        std::getline(is, line);
+        if (line.find(native_desc) == std::string::npos) {
+          amrex::Error("stream=1 needs the checkpoint FABs in the native format");
+        }
+        data_start[j] = is.tellg();
+      }
+
+      const Box& bx = fab_box[j];
+      const long pos = data_start[j] + (c * bx.numPts() + bx.index(iv)) * sizeof(Real);
+
+      is.seekg(pos, std::ios::beg);
+      is.read((char*) buf, len * sizeof(Real));
+
+      if( ! is.good()) {
+        amrex::Error("StreamMultiFab: reading " + file_name + " failed");
+      }
+    }
+
+    std::string dir_name;
+    std::string file_name;
+    std::string native_desc;
+    VisMF::Header hdr;
+    BoxArray fab_box;
+    Vector<long> data_start;
+    VisMF::IO_Buffer io_buffer;
+    std::ifstream is;
+};
+
+// ---------------------------------------------------------------
+// Write the MultiFab out_name on the boxes ba of level lev, taking the
+// data from the MultiFab src_name: shifted by shift if ratio is 1, and
+// otherwise averaged down by ratio from the level above.  Each rank
+// builds and writes its boxes one at a time, to its own file, and the
+// I/O processor then writes the VisMF header.  Only the part of each
+// old FAB that a box covers is read, so the data held at once is one
+// box (and its weights), whatever the size of the old boxes.
+
+static void StreamMultiFab(const BoxArray& ba, const std::string& src_name,
+                           const IntVect& shift, int ratio, int lev,
+                           const std::string& out_name) {
+
+    VisMF src(src_name);
+
+    const int ncomp = src.nComp();
+    const int ngrow = src.nGrow();
+
+    BoxArray src_ba(src.boxArray());
+    src_ba.shift(shift);
+
+    FabRunReader reader(src_name, shift, ngrow);
+
+    const int nb = ba.size();
+    DistributionMapping dmap {ba};
+
+    const int myproc = ParallelDescriptor::MyProc();
+
+    Vector<long> offset(nb, 0);
+    Vector<Real> fab_min(nb * ncomp, 0.0);
+    Vector<Real> fab_max(nb * ncomp, 0.0);
+
+    const std::string file_name = amrex::Concatenate(out_name + "_D_", myproc, 5);
+
+    VisMF::IO_Buffer io_buffer(VisMF::IO_Buffer_Size);
+
+    std::ofstream os;
+
+    for (int b = 0; b < nb; b++) {
+
+      if (dmap[b] != myproc) continue;
+
+      if (!os.is_open()) {
+        os.rdbuf()->pubsetbuf(io_buffer.dataPtr(), io_buffer.size());
+        os.open(file_name.c_str(), std::ios::out|std::ios::trunc|std::ios::binary);
+        if( ! os.good()) {
+          amrex::FileOpenFailed(file_name);
+        }
+      }
+
+      const Box& vbx = ba[b];
+      const Box  gbx = amrex::grow(vbx, ngrow);
+
+      FArrayBox dst(gbx, ncomp);
+      dst.setVal(0.0);
+
+      if (ratio == 1) {
+
+        // This box was cut from a single old box, whose data (with its
+        // ghost zones) cover all of it.
+        int j = -1;
+        for (const auto& is : src_ba.intersections(vbx)) {
+          if (is.second == vbx) {
+            j = is.first;
+            break;
+          }
+        }
+        BL_ASSERT(j >= 0);
+
+        // Read the runs of cells that are contiguous both on disk and
+        // in dst: whole planes, or more, when the box spans the old one.
+        const Box& fbx = reader.fab_box[j];
+        const Box ovlp = fbx & gbx;
+
+        Box runs(ovlp);
+        long run = ovlp.length(0);
+        runs.setBig(0, ovlp.smallEnd(0));
+        for (int d = 1; d < BL_SPACEDIM; d++) {
+          if (ovlp.length(d-1) != fbx.length(d-1) || ovlp.length(d-1) != gbx.length(d-1)) break;
+          run *= ovlp.length(d);
+          runs.setBig(d, ovlp.smallEnd(d));
+        }
+
+        for (int c = 0; c < ncomp; c++)
+          for (IntVect iv = runs.smallEnd(); iv <= runs.bigEnd(); runs.next(iv))
+            reader.read(j, c, iv, run, dst.dataPtr(c) + gbx.index(iv));
+
+      } else {
+
+        // Average the valid data of the level above over every cell it
+        // covers, ghost zones included, reading it a row at a time.
+        FArrayBox vol(gbx, 1);
+        vol.setVal(0.0);
+
+        Vector<Real> row;
+
+        for (const auto& is : src_ba.intersections(amrex::refine(gbx, ratio))) {
+
+          const int  j   = is.first;
+          const Box& fbx = is.second;
+
+          const int nx = fbx.length(0);
+
+          Box rows(fbx);
+          rows.setBig(0, fbx.smallEnd(0));
+          row.resize(nx);
+
+          for (int c = 0; c < ncomp; c++) {
+            for (IntVect riv = rows.smallEnd(); riv <= rows.bigEnd(); rows.next(riv)) {
+
+              reader.read(j, c, riv, nx, row.dataPtr());
+
+              IntVect iv(riv);
+              for (int i = 0; i < nx; i++, iv[0]++) {
+                const IntVect civ = amrex::coarsen(iv, ratio);
+                const Real w = CellVolume(iv, lev+1);
+                dst(civ, c) += w * row[i];
+                if (c == 0)
+                  vol(civ) += w;
+              }
+            }
+          }
+        }
+
+        for (IntVect iv = gbx.smallEnd(); iv <= gbx.bigEnd(); gbx.next(iv))
+          if (vol(iv) > 0.0)
+            for (int c = 0; c < ncomp; c++)
+              dst(iv, c) /= vol(iv);
+
+      }
+
+      for (int c = 0; c < ncomp; c++) {
+        fab_min[b*ncomp + c] = dst.min(vbx, c);
+        fab_max[b*ncomp + c] = dst.max(vbx, c);
+      }
+
+      offset[b] = os.tellp();
+      dst.writeOn(os);
+
+      if( ! os.good()) {
+        amrex::Error("StreamMultiFab: write failed");
+      }
+    }
+
+    if (os.is_open()) {
+      os.close();
+    }
+
+    // Each box has a single owner, so a sum collects them all.
+    const int IOProc = ParallelDescriptor::IOProcessorNumber();
+    ParallelDescriptor::ReduceLongSum(offset.dataPtr(), nb, IOProc);
+    ParallelDescriptor::ReduceRealSum(fab_min.dataPtr(), nb * ncomp, IOProc);
+    ParallelDescriptor::ReduceRealSum(fab_max.dataPtr(), nb * ncomp, IOProc);
+
+    if (ParallelDescriptor::IOProcessor()) {
+
+      VisMF::Header hdr;
+
+      hdr.m_vers  = VisMF::Header::Version_v1;
+      hdr.m_how   = VisMF::NFiles;
+      hdr.m_ncomp = ncomp;
+      hdr.m_ngrow = ngrow;
+      hdr.m_ba    = ba;
+
+      hdr.m_fod.resize(nb);
+      hdr.m_min.resize(nb);
+      hdr.m_max.resize(nb);
+
+      const std::string base_name = VisMF::BaseName(out_name);
+
+      for (int b = 0; b < nb; b++) {
+        hdr.m_fod[b] = VisMF::FabOnDisk(amrex::Concatenate(base_name + "_D_", dmap[b], 5), offset[b]);
+        hdr.m_min[b].assign(fab_min.begin() + b*ncomp, fab_min.begin() + (b+1)*ncomp);
+        hdr.m_max[b].assign(fab_max.begin() + b*ncomp, fab_max.begin() + (b+1)*ncomp);
+      }
+
+      const std::string hdr_name = out_name + "_H";
+
+      std::ofstream hos;
+      hos.open(hdr_name.c_str(), std::ios::out|std::ios::trunc);
+      if( ! hos.good()) {
+        amrex::FileOpenFailed(hdr_name);
+      }
+
+      hos << hdr;
+
+      if( ! hos.good()) {
+        amrex::Error("StreamMultiFab: writing the header failed");
+      }
+    }
+
+    // The level below may read this one next.
+    ParallelDescriptor::Barrier();
+}
+
+// ---------------------------------------------------------------
+static void StreamCheckpointFile(const std::string &outFileName) {
+    // In checkpoint files always write out FABs in NATIVE format.
+    FABio::Format thePrevFormat = FArrayBox::getFormat();
+    FArrayBox::setFormat(FABio::FAB_NATIVE);
+
+    static const std::string NewSuffix("_New_MF");
+    static const std::string OldSuffix("_Old_MF");
+
+    const std::string ckfile = outFileName;
+    const int n = ref_ratios.size();
+    const int finest_level = fakeAmr.finest_level;
+
+    // Only the I/O processor makes the directories if they don't already exist.
+    if(ParallelDescriptor::IOProcessor()) {
+      if( ! amrex::UtilCreateDirectory(ckfile, 0755)) {
+        amrex::CreateDirectoryFailed(ckfile);
+      }
+      for(int lev(0); lev <= finest_level; ++lev) {
+        const std::string FullPath = amrex::Concatenate(ckfile + "/Level_", lev, 1);
+        if( ! amrex::UtilCreateDirectory(FullPath, 0755)) {
+          amrex::CreateDirectoryFailed(FullPath);
+        }
+      }
+    }
+    // Force other processors to wait till directories are built.
+    ParallelDescriptor::Barrier();
+
+    // Copy some standard auxiliary files to the new checkpoint.
+    CopyCastroHeader(CheckFileIn, outFileName);
+
+    // Finest level first, so each new level can be averaged down from
+    // the one above it.
+    for(int lev(finest_level); lev >= 0; --lev) {
+
+      FakeAmrLevel &falRef = fakeAmr.fakeAmrLevels[lev];
+      const int ndesc = falRef.state.size();
+
+      for(int i(0); i < ndesc; ++i) {
+        for(int set(0); set < falRef.state[i].nsets; ++set) {
+
+          const std::string suffix = (set == 0) ? NewSuffix : OldSuffix;
+          const std::string name = amrex::Concatenate("/SD_", i, 1) + suffix;
+
+          const std::string out_name = amrex::Concatenate(ckfile + "/Level_", lev, 1) + name;
+
+          if (lev >= n) {
+            StreamMultiFab(falRef.grids, falRef.state[i].mf_name[set],
+                           stream_shift[lev], 1, lev, out_name);
+          } else {
+            const std::string fine_name = amrex::Concatenate(ckfile + "/Level_", lev+1, 1) + name;
+            StreamMultiFab(falRef.grids, fine_name,
+                           IntVect::TheZeroVector(), ref_ratios[lev], lev, out_name);
+          }
+        }
+      }
+
+      if (verbose && ParallelDescriptor::IOProcessor()) {
+        std::cout << "New checkpoint level    " << lev << std::endl;
+        std::cout << " ... domain is       " << fakeAmr.geom[lev].Domain() << std::endl;
+        std::cout << " ...     dx is       " << fakeAmr.geom[lev].CellSize()[0] << std::endl;
+        std::cout << " ...  grids are      " << falRef.grids.size() << " boxes" << std::endl;
+        std::cout << "  " << std::endl;
+      }
+    }
+
+    // Write the main header file.
+    if(ParallelDescriptor::IOProcessor()) {
+
+      std::string HeaderFileName = ckfile + "/Header";
+
+      VisMF::IO_Buffer io_buffer(VisMF::IO_Buffer_Size);
+
+      std::ofstream HeaderFile;
+
+      HeaderFile.rdbuf()->pubsetbuf(io_buffer.dataPtr(), io_buffer.size());
+
+      HeaderFile.open(HeaderFileName.c_str(),
+                      std::ios::out|std::ios::trunc|std::ios::binary);
+
+      if( ! HeaderFile.good()) {
+        amrex::FileOpenFailed(HeaderFileName);
+      }
+
+      HeaderFile.precision(15);
+
+      WriteHeaderGlobals(HeaderFile);
+
+      for(int lev(0); lev <= finest_level; ++lev) {
+
+        FakeAmrLevel &falRef = fakeAmr.fakeAmrLevels[lev];
+        const int ndesc = falRef.state.size();
+
+        HeaderFile << lev << '\n' << falRef.geom  << '\n';
+        falRef.grids.writeOn(HeaderFile);
+        HeaderFile << ndesc << '\n';
+
+        for(int i(0); i < ndesc; ++i) {
+
+          FakeStateData &sd = falRef.state[i];
+
+          HeaderFile << sd.domain << '\n';
+
+          sd.grids.writeOn(HeaderFile);
+
+          HeaderFile << sd.old_time.start << '\n'
+                     << sd.old_time.stop  << '\n'
+                     << sd.new_time.start << '\n'
+                     << sd.new_time.stop  << '\n';
+
+          // The names are relative to the Header file.
+          const std::string name = amrex::Concatenate("Level_", lev, 1) + amrex::Concatenate("/SD_", i, 1);
+
+          HeaderFile << sd.nsets << '\n';
+          if (sd.nsets >= 1) HeaderFile << name << NewSuffix << '\n';
+          if (sd.nsets >= 2) HeaderFile << name << OldSuffix << '\n';
+        }
+      }
+
+      if( ! HeaderFile.good()) {
+        amrex::Error("Amr::checkpoint() failed");
+      }
+    }
+
+    ParallelDescriptor::Barrier();
+
+    FArrayBox::setFormat(thePrevFormat);
+}
+
+
+// ---------------------------------------------------------------
+int main(int argc, char *argv[]) {
+    amrex::Initialize(argc,argv);
+
+    if(argc < 3) {
+      PrintUsage(argv[0]);
+    }
+
+    ScanArguments();
+
+    if(verbose && ParallelDescriptor::IOProcessor()) {
+      cout << " " << std::endl;
+      cout << "Reading from old checkpoint file: " <<  CheckFileIn << endl;
+      cout << " " << std::endl;
+    }
+
+    if(verbose && ParallelDescriptor::IOProcessor()) {
+      if (star_at_center == 0) cout << "Star at corner " << endl;
+      if (star_at_center == 1) cout << "Star at center " << endl;
+      cout << " " << std::endl;
+    }
+
+    if (stream) {
+
+       // Read the headers of the original checkpoint, set up the new
+       // levels and the grown domain, and then move the data across
+       // one box at a time.
+       ReadCheckpointHeaders(CheckFileIn);
+
+       SetupStreamedLevels();
+
+       StreamCheckpointFile(CheckFileOut);
+
+    } else {
+
+    // Read in the original checkpoint directory and add a coarser level covering the same domain 
+    ReadCheckpointFile(CheckFileIn);
+
+    // Enlarge the new level 0
+    ConvertData();
 
     // Write out the new checkpoint directory
     WriteCheckpointFile(CheckFileIn, CheckFileOut);
 
+    }
+
     if(verbose && ParallelDescriptor::IOProcessor()) {
       cout << " " << std::endl;
       cout << "Finished writing to new checkpoint file: " <<  CheckFileOut << endl;